@@ -0,0 +1,466 @@
+#pragma once
+
+#include <array>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "./cursor.hpp"
+#include "./detail/key_index.hpp"
+#include "./detail/preprocessor.hpp"
+#include "./detail/value_builder.hpp"
+#include "./value.hpp"
+
+
+
+/*
+ * Declares which members of a struct are read from the JSON5 object keys of
+ * the same names:
+ *
+ *     struct point
+ *     {
+ *         int x;
+ *         int y;
+ *     };
+ *     JSON5_BINDING(point, x, y)
+ *
+ * Place it in the namespace of the struct. It defines the function
+ * json5_binding_fields(), which is found by argument-dependent lookup and
+ * may also be written by hand, to use key names other than member names:
+ *
+ *     constexpr auto json5_binding_fields(const point*)
+ *     {
+ *         return std::make_tuple(
+ *             json5::field("X", &point::x), json5::field("Y", &point::y));
+ *     }
+ */
+#define JSON5_BINDING(T, ...) \
+    inline constexpr auto json5_binding_fields(const T*) \
+    { \
+        return std::make_tuple( \
+            JSON5_FOR_EACH(JSON5_BINDING_FIELD, T, __VA_ARGS__)); \
+    }
+
+#define JSON5_BINDING_FIELD(T, member) ::json5::field(#member, &T::member)
+
+
+
+namespace json5
+{
+
+template <typename Class, typename Member>
+struct field_binding
+{
+    std::string_view name;
+    Member Class::*member;
+};
+
+
+
+template <typename Class, typename Member>
+constexpr field_binding<Class, Member> field(
+    std::string_view name,
+    Member Class::*member) noexcept
+{
+    return {name, member};
+}
+
+
+
+namespace detail
+{
+
+template <typename T, typename = void>
+struct has_binding : std::false_type
+{
+};
+
+template <typename T>
+struct has_binding<
+    T,
+    std::void_t<decltype(json5_binding_fields(std::declval<const T*>()))>>
+    : std::true_type
+{
+};
+
+
+
+// Type of the value the current event of the cursor belongs to.
+inline value_type event_type(cursor_event e) noexcept
+{
+    switch (e)
+    {
+    case cursor_event::null: return value_type::null;
+    case cursor_event::boolean: return value_type::boolean;
+    case cursor_event::integer: return value_type::integer;
+    case cursor_event::number: return value_type::number;
+    case cursor_event::string:
+    case cursor_event::key: return value_type::string;
+    case cursor_event::start_array:
+    case cursor_event::end_array: return value_type::array;
+    default: return value_type::object;
+    }
+}
+
+
+
+inline void expect_event(const cursor& c, cursor_event e, value_type type)
+{
+    if (c.event() != e)
+    {
+        JSON5_THROW(invalid_type_error{event_type(c.event()), type});
+    }
+}
+
+
+
+/*
+ * binder<T>::read(c, out) reads the value whose first event is the current
+ * one of c into out. For arrays and objects, it leaves c at their last
+ * event.
+ */
+template <typename T, typename = void>
+struct binder;
+
+
+
+template <>
+struct binder<bool>
+{
+    static void read(cursor& c, bool& out)
+    {
+        out = c.get_boolean();
+    }
+};
+
+
+
+template <typename T>
+struct binder<
+    T,
+    std::enable_if_t<
+        std::is_integral<T>::value && !std::is_same<T, bool>::value>>
+{
+    static void read(cursor& c, T& out)
+    {
+        const auto v = c.get_integer();
+        const auto t = static_cast<T>(v);
+        if (static_cast<integer_type>(t) != v ||
+            (std::is_unsigned<T>::value && v < 0))
+        {
+            JSON5_THROW(std::out_of_range{
+                "integer " + std::to_string(v) + " out of range"});
+        }
+        out = t;
+    }
+};
+
+
+
+template <typename T>
+struct binder<T, std::enable_if_t<std::is_floating_point<T>::value>>
+{
+    static void read(cursor& c, T& out)
+    {
+        if (c.event() == cursor_event::integer)
+        {
+            out = static_cast<T>(c.get_integer());
+        }
+        else
+        {
+            out = static_cast<T>(c.get_number());
+        }
+    }
+};
+
+
+
+template <>
+struct binder<std::string>
+{
+    static void read(cursor& c, std::string& out)
+    {
+        const auto s = c.get_string();
+        out.assign(s.data(), s.size());
+    }
+};
+
+
+
+template <typename T>
+struct binder<std::optional<T>>
+{
+    static void read(cursor& c, std::optional<T>& out)
+    {
+        if (c.event() == cursor_event::null)
+        {
+            out.reset();
+            return;
+        }
+        binder<T>::read(c, out.emplace());
+    }
+};
+
+
+
+template <typename T, typename Allocator>
+struct binder<std::vector<T, Allocator>>
+{
+    static void read(cursor& c, std::vector<T, Allocator>& out)
+    {
+        expect_event(c, cursor_event::start_array, value_type::array);
+        out.clear();
+        while (c.next() != cursor_event::end_array)
+        {
+            binder<T>::read(c, out.emplace_back());
+        }
+    }
+};
+
+
+
+// The elements of std::vector<bool> cannot be bound to a bool&.
+template <typename Allocator>
+struct binder<std::vector<bool, Allocator>>
+{
+    static void read(cursor& c, std::vector<bool, Allocator>& out)
+    {
+        expect_event(c, cursor_event::start_array, value_type::array);
+        out.clear();
+        while (c.next() != cursor_event::end_array)
+        {
+            bool element;
+            binder<bool>::read(c, element);
+            out.push_back(element);
+        }
+    }
+};
+
+
+
+// std::map and std::unordered_map with string keys.
+template <typename Map>
+struct map_binder
+{
+    static void read(cursor& c, Map& out)
+    {
+        expect_event(c, cursor_event::start_object, value_type::object);
+        out.clear();
+        while (c.next() == cursor_event::key)
+        {
+            auto& v = out[std::string{c.get_string()}];
+            c.next();
+            binder<typename Map::mapped_type>::read(c, v);
+        }
+    }
+};
+
+
+
+template <typename T, typename Compare, typename Allocator>
+struct binder<std::map<std::string, T, Compare, Allocator>>
+    : map_binder<std::map<std::string, T, Compare, Allocator>>
+{
+};
+
+
+
+template <typename T, typename Hash, typename Equal, typename Allocator>
+struct binder<std::unordered_map<std::string, T, Hash, Equal, Allocator>>
+    : map_binder<std::unordered_map<std::string, T, Hash, Equal, Allocator>>
+{
+};
+
+
+
+// Keeps a part of the source whose shape is not known in advance as a
+// value.
+template <>
+struct binder<value>
+{
+    static void read(cursor& c, value& out)
+    {
+        value_builder builder;
+        size_t depth = 0;
+        while (true)
+        {
+            switch (c.event())
+            {
+            case cursor_event::null: builder.on_null(); break;
+            case cursor_event::boolean:
+                builder.on_boolean(c.get_boolean());
+                break;
+            case cursor_event::integer:
+                builder.on_integer(c.get_integer());
+                break;
+            case cursor_event::number: builder.on_number(c.get_number()); break;
+            case cursor_event::string: builder.on_string(c.get_string()); break;
+            case cursor_event::key: builder.on_key(c.get_string()); break;
+            case cursor_event::start_array:
+                builder.on_start_array();
+                ++depth;
+                break;
+            case cursor_event::end_array:
+                builder.on_end_array();
+                --depth;
+                break;
+            case cursor_event::start_object:
+                builder.on_start_object();
+                ++depth;
+                break;
+            case cursor_event::end_object:
+                builder.on_end_object();
+                --depth;
+                break;
+            default: break;
+            }
+            if (depth == 0)
+                break;
+            c.next();
+        }
+        out = builder.finish();
+    }
+};
+
+
+
+/*
+ * Structs with a binding are read from objects. Keys without a field are
+ * skipped without being decoded, and fields without a key keep their
+ * values.
+ *
+ * Comparing a key with the name of each field costs little, because the
+ * names are constants: most comparisons stop at the length. For structs
+ * with many fields, keys are looked up in a perfect hash table of the names
+ * built at compile time instead, and dispatched through a table of readers.
+ */
+template <typename T>
+struct binder<T, std::enable_if_t<has_binding<T>::value>>
+{
+    static void read(cursor& c, T& out)
+    {
+        expect_event(c, cursor_event::start_object, value_type::object);
+        while (c.next() == cursor_event::key)
+        {
+            if (!read_field(c, out, c.get_string()))
+            {
+                c.skip();
+            }
+        }
+    }
+
+
+
+private:
+    using reader = bool (*)(cursor&, T&, std::string_view);
+
+    static constexpr auto fields =
+        json5_binding_fields(static_cast<const T*>(nullptr));
+    static constexpr auto count = std::tuple_size<decltype(fields)>::value;
+    // Up to this number of fields, comparing the key with every name is
+    // about as fast as hashing it.
+    static constexpr size_t max_compared_fields = 32;
+
+
+
+    static bool read_field(cursor& c, T& out, std::string_view key)
+    {
+        if constexpr (count <= max_compared_fields)
+        {
+            return read_any_field(
+                c, out, key, std::make_index_sequence<count>{});
+        }
+        else
+        {
+            const auto i = index.candidate(key);
+            return i != count && readers[i](c, out, key);
+        }
+    }
+
+
+
+    template <size_t... I>
+    static bool read_any_field(
+        cursor& c,
+        T& out,
+        std::string_view key,
+        std::index_sequence<I...>)
+    {
+        return (... || read_field_at<I>(c, out, key));
+    }
+
+
+
+    // Reads the value of the I-th field if key is its name.
+    template <size_t I>
+    static bool read_field_at(cursor& c, T& out, std::string_view key)
+    {
+        if (std::get<I>(fields).name != key)
+            return false;
+
+        auto& member = out.*std::get<I>(fields).member;
+        c.next();
+        binder<std::remove_reference_t<decltype(member)>>::read(c, member);
+        return true;
+    }
+
+
+
+    template <size_t... I>
+    static constexpr std::array<std::string_view, count> names(
+        std::index_sequence<I...>) noexcept
+    {
+        return {{std::get<I>(fields).name...}};
+    }
+
+
+
+    template <size_t... I>
+    static constexpr std::array<reader, count> make_readers(
+        std::index_sequence<I...>) noexcept
+    {
+        return {{&read_field_at<I>...}};
+    }
+
+
+
+    static constexpr key_index<count> index{
+        names(std::make_index_sequence<count>{})};
+    static constexpr std::array<reader, count> readers =
+        make_readers(std::make_index_sequence<count>{});
+};
+
+} // namespace detail
+
+
+
+// Reads the source into out, without building a value. See JSON5_BINDING()
+// for structs; arithmetic types, std::string, std::optional, std::vector,
+// std::map and std::unordered_map with string keys, and value are
+// supported as well.
+template <typename T>
+void parse_into(std::string_view source, T& out)
+{
+    cursor c{source};
+    c.next();
+    detail::binder<T>::read(c, out);
+    c.next(); // eof
+}
+
+
+
+template <typename T>
+T parse_as(std::string_view source)
+{
+    T out{};
+    parse_into(source, out);
+    return out;
+}
+
+} // namespace json5
@@ -0,0 +1,350 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+#include "./detail/lexer.hpp"
+#include "./detail/parser.hpp"
+#include "./detail/preprocessor.hpp"
+#include "./detail/util.hpp"
+#include "./types.hpp"
+#include "./value_type.hpp"
+
+
+
+namespace json5
+{
+
+enum class cursor_event
+{
+    null,
+    boolean,
+    integer,
+    number,
+    string,
+    key,
+    start_array,
+    end_array,
+    start_object,
+    end_object,
+    eof,
+};
+
+
+
+/*
+ * Pull parser. Each call to next() reads the source up to the next event and
+ * returns it; the value of a scalar event can then be read with get_*().
+ *
+ *     json5::cursor c{source};
+ *     c.next(); // start_object
+ *     while (c.next() == json5::cursor_event::key)
+ *     {
+ *         if (c.get_string() == "version")
+ *         {
+ *             c.next();
+ *             version = c.get_integer();
+ *         }
+ *         else
+ *         {
+ *             c.skip();
+ *         }
+ *     }
+ *
+ * The source is not copied; it must outlive the cursor.
+ */
+class cursor
+{
+public:
+    explicit cursor(std::string_view source)
+        : _ts(source)
+    {
+    }
+
+
+
+    cursor_event next()
+    {
+        if (_stack.empty())
+        {
+            if (!_started)
+            {
+                _started = true;
+                return read_value();
+            }
+
+            const auto tok = _ts.get();
+            if (tok.type() != detail::token_type::eof)
+            {
+                JSON5_THROW(detail::parse_error(tok, "EOF"));
+            }
+            return _event = cursor_event::eof;
+        }
+
+        if (_needs_colon)
+        {
+            _needs_colon = false;
+            const auto kv_separator = _ts.get();
+            if (kv_separator.type() != detail::token_type::colon)
+            {
+                JSON5_THROW(detail::parse_error(kv_separator, "':'"));
+            }
+            return read_value();
+        }
+
+        const bool in_object = _stack.back();
+        if (_needs_delimiter)
+        {
+            const auto delimiter = _ts.get();
+            if (delimiter.type() == close_token(in_object))
+            {
+                return close();
+            }
+            else if (delimiter.type() != detail::token_type::comma)
+            {
+                JSON5_THROW(detail::parse_error(
+                    delimiter, in_object ? "'}' or ','" : "']' or ','"));
+            }
+        }
+
+        if (_ts.peek().type() == detail::token_type::eof)
+        {
+            JSON5_THROW(detail::parse_error(
+                detail::token{detail::token_type::eof},
+                in_object ? "any JSON5 value or '}'"
+                          : "any JSON5 value or ']'"));
+        }
+        else if (_ts.peek().type() == close_token(in_object))
+        {
+            _ts.get();
+            return close();
+        }
+
+        if (!in_object)
+            return read_value();
+
+        _token = _ts.get();
+        switch (_token.type())
+        {
+        case detail::token_type::null: _key = "null"; break;
+        case detail::token_type::true_: _key = "true"; break;
+        case detail::token_type::false_: _key = "false"; break;
+        case detail::token_type::infinity: _key = "Infinity"; break;
+        case detail::token_type::nan: _key = "NaN"; break;
+        case detail::token_type::string:
+        case detail::token_type::identifier: _key = _token.get_string(); break;
+        default:
+            JSON5_THROW(detail::parse_error(_token, "string or identifier"));
+        }
+        _needs_colon = true;
+        return _event = cursor_event::key;
+    }
+
+
+
+    cursor_event event() const noexcept
+    {
+        return _event;
+    }
+
+
+
+    // Nesting level of the current position. It is 1 inside the top-level
+    // array or object, including its start and end events.
+    size_t depth() const noexcept
+    {
+        const bool closed = _event == cursor_event::end_array ||
+            _event == cursor_event::end_object;
+        return _stack.size() + (closed ? 1 : 0);
+    }
+
+
+
+    /*
+     * Skips without decoding:
+     * - after start_array or start_object, the rest of the container, and
+     *   moves to its end_array or end_object;
+     * - after key, the value of the member.
+     * Otherwise, does nothing. Skipping a member's value leaves event() as
+     * key. The skipped part is not validated except that brackets are
+     * balanced.
+     */
+    void skip()
+    {
+        switch (_event)
+        {
+        case cursor_event::start_array:
+            _ts.skip_value(1);
+            close();
+            break;
+        case cursor_event::start_object:
+            _ts.skip_value(1);
+            close();
+            break;
+        case cursor_event::key:
+            if (_needs_colon)
+            {
+                _needs_colon = false;
+                const auto kv_separator = _ts.get();
+                if (kv_separator.type() != detail::token_type::colon)
+                {
+                    JSON5_THROW(detail::parse_error(kv_separator, "':'"));
+                }
+                _ts.skip_value(0);
+                _needs_delimiter = true;
+            }
+            break;
+        default: break;
+        }
+    }
+
+
+
+    boolean_type get_boolean() const
+    {
+        expect(value_type::boolean);
+        return _token.type() == detail::token_type::true_;
+    }
+
+
+
+    integer_type get_integer() const
+    {
+        expect(value_type::integer);
+        return _token.get_integer();
+    }
+
+
+
+    number_type get_number() const
+    {
+        expect(value_type::number);
+        switch (_token.type())
+        {
+        case detail::token_type::infinity: return detail::infinity();
+        case detail::token_type::nan: return detail::nan();
+        default: return _token.get_number();
+        }
+    }
+
+
+
+    // Returns a string value or a key. It is valid until the next call to
+    // next() or skip().
+    std::string_view get_string() const
+    {
+        if (_event == cursor_event::key)
+            return _key;
+
+        expect(value_type::string);
+        return _token.get_string();
+    }
+
+
+
+private:
+    detail::token_stream _ts;
+    // true for an object, false for an array.
+    std::vector<bool> _stack;
+    cursor_event _event = cursor_event::eof;
+    bool _started = false;
+    // A key has been read but not the ':' after it.
+    bool _needs_colon = false;
+    // A value in the current container has been read but not the ',' or
+    // closing bracket after it.
+    bool _needs_delimiter = false;
+    detail::token _token;
+    std::string_view _key;
+
+
+
+    cursor_event read_value()
+    {
+        _token = _ts.get();
+        // Scalars are complete at once, containers once they are closed.
+        _needs_delimiter = _token.type() != detail::token_type::bracket_left &&
+            _token.type() != detail::token_type::brace_left;
+        switch (_token.type())
+        {
+        case detail::token_type::bracket_left:
+            open(false);
+            return _event = cursor_event::start_array;
+        case detail::token_type::brace_left:
+            open(true);
+            return _event = cursor_event::start_object;
+        case detail::token_type::null: return _event = cursor_event::null;
+        case detail::token_type::true_:
+        case detail::token_type::false_:
+            return _event = cursor_event::boolean;
+        case detail::token_type::infinity:
+        case detail::token_type::nan:
+        case detail::token_type::number: return _event = cursor_event::number;
+        case detail::token_type::integer:
+            return _event = cursor_event::integer;
+        case detail::token_type::string: return _event = cursor_event::string;
+        default: JSON5_THROW(detail::parse_error(_token, "any JSON5 value"));
+        }
+    }
+
+
+
+    // The values read through a cursor, such as by parse_as<value>(), are
+    // limited in depth as those built by parse().
+    void open(bool object)
+    {
+        if (_stack.size() == detail::max_depth)
+        {
+            JSON5_THROW(detail::too_deep_error());
+        }
+        _stack.push_back(object);
+    }
+
+
+
+    cursor_event close()
+    {
+        const bool in_object = _stack.back();
+        _stack.pop_back();
+        _needs_delimiter = true;
+        return _event = in_object ? cursor_event::end_object
+                                  : cursor_event::end_array;
+    }
+
+
+
+    static detail::token_type close_token(bool in_object) noexcept
+    {
+        return in_object ? detail::token_type::brace_right
+                         : detail::token_type::bracket_right;
+    }
+
+
+
+    // Type of the value the current event belongs to.
+    value_type type() const noexcept
+    {
+        switch (_event)
+        {
+        case cursor_event::null: return value_type::null;
+        case cursor_event::boolean: return value_type::boolean;
+        case cursor_event::integer: return value_type::integer;
+        case cursor_event::number: return value_type::number;
+        case cursor_event::string:
+        case cursor_event::key: return value_type::string;
+        case cursor_event::start_array:
+        case cursor_event::end_array: return value_type::array;
+        default: return value_type::object;
+        }
+    }
+
+
+
+    void expect(value_type expected_type) const
+    {
+        if (type() != expected_type)
+        {
+            JSON5_THROW(invalid_type_error{type(), expected_type});
+        }
+    }
+};
+
+} // namespace json5
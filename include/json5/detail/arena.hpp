@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include "./preprocessor.hpp"
+
+
+
+namespace json5
+{
+namespace detail
+{
+
+/*
+ * Monotonic bump-pointer allocator. Memory is obtained in blocks which grow
+ * geometrically, and it is released only when the arena itself is destroyed.
+ * Objects placed in the arena must not need their destructors to be run.
+ */
+class arena
+{
+public:
+    explicit arena(size_t initial_block_size = 4096) noexcept
+        : _head(nullptr)
+        , _cur(nullptr)
+        , _end(nullptr)
+        , _next_block_size(initial_block_size < 64 ? 64 : initial_block_size)
+        , _block_count(0)
+    {
+    }
+
+
+
+    arena(const arena&) = delete;
+    arena& operator=(const arena&) = delete;
+
+
+
+    arena(arena&& other) noexcept
+        : _head(std::exchange(other._head, nullptr))
+        , _cur(std::exchange(other._cur, nullptr))
+        , _end(std::exchange(other._end, nullptr))
+        , _next_block_size(other._next_block_size)
+        , _block_count(std::exchange(other._block_count, 0))
+    {
+    }
+
+
+
+    arena& operator=(arena&& other) noexcept
+    {
+        arena tmp = std::move(other);
+        tmp.swap(*this);
+        return *this;
+    }
+
+
+
+    ~arena()
+    {
+        while (_head)
+        {
+            const auto next = _head->next;
+            std::free(_head);
+            _head = next;
+        }
+    }
+
+
+
+    void swap(arena& other) noexcept
+    {
+        std::swap(_head, other._head);
+        std::swap(_cur, other._cur);
+        std::swap(_end, other._end);
+        std::swap(_next_block_size, other._next_block_size);
+        std::swap(_block_count, other._block_count);
+    }
+
+
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+    {
+        auto p = align_up(_cur, alignment);
+        if (!p || _end < p || static_cast<size_t>(_end - p) < size)
+        {
+            grow(size + alignment);
+            p = align_up(_cur, alignment);
+        }
+        _cur = p + size;
+        return p;
+    }
+
+
+
+    template <typename T>
+    T* allocate_array(size_t n)
+    {
+        return static_cast<T*>(allocate(sizeof(T) * n, alignof(T)));
+    }
+
+
+
+    size_t block_count() const noexcept
+    {
+        return _block_count;
+    }
+
+
+
+private:
+    struct block
+    {
+        block* next;
+    };
+
+
+    block* _head;
+    char* _cur;
+    char* _end;
+    size_t _next_block_size;
+    size_t _block_count;
+
+
+
+    static char* align_up(char* p, size_t alignment) noexcept
+    {
+        if (!p)
+            return nullptr;
+        const auto n = reinterpret_cast<uintptr_t>(p);
+        return p + ((alignment - n % alignment) % alignment);
+    }
+
+
+
+    void grow(size_t min_size)
+    {
+        size_t size = _next_block_size;
+        while (size < min_size + sizeof(block))
+        {
+            size *= 2;
+        }
+        auto b = static_cast<block*>(std::malloc(size));
+        if (!b)
+        {
+            JSON5_THROW(std::bad_alloc{});
+        }
+        b->next = _head;
+        _head = b;
+        _cur = reinterpret_cast<char*>(b + 1);
+        _end = reinterpret_cast<char*>(b) + size;
+        _next_block_size = size * 2;
+        ++_block_count;
+    }
+};
+
+} // namespace detail
+} // namespace json5
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <cstring>
+#include <limits>
+#include <vector>
+#include "../document.hpp"
+#include "./arena.hpp"
+#include "./parser.hpp"
+#include "./preprocessor.hpp"
+
+
+
+namespace json5
+{
+namespace detail
+{
+
+/*
+ * Parser handler which builds a document in an arena. Elements and members
+ * of the containers being parsed are collected on two reusable stacks and
+ * copied into the arena in one piece when the container is closed.
+ */
+class document_builder
+{
+public:
+    document_builder(
+        arena& arena,
+        intern_table* table,
+        const document_options& opts)
+        : _arena(arena)
+        , _table(table)
+        , _opts(opts)
+    {
+    }
+
+
+
+    void on_null()
+    {
+        auto node = make_node(value_type::null);
+        add(node);
+    }
+
+
+
+    void on_boolean(boolean_type v)
+    {
+        auto node = make_node(value_type::boolean);
+        node.as.boolean = v;
+        add(node);
+    }
+
+
+
+    void on_integer(integer_type v)
+    {
+        auto node = make_node(value_type::integer);
+        node.as.integer = v;
+        add(node);
+    }
+
+
+
+    void on_number(number_type v)
+    {
+        auto node = make_node(value_type::number);
+        node.as.number = v;
+        add(node);
+    }
+
+
+
+    void on_string(std::string_view v)
+    {
+        const auto limit = _opts.intern_string_values_up_to;
+        const auto s = _table && limit != 0 && v.size() <= limit
+            ? intern_string(v)
+            : copy_string(v);
+        auto node = make_node(value_type::string);
+        node.size = s.second;
+        node.as.string = s.first;
+        add(node);
+    }
+
+
+
+    void on_key(std::string_view k)
+    {
+        // The member is completed when its value arrives.
+        const auto s = _opts.intern_keys ? intern_string(k) : copy_string(k);
+        document_member member;
+        member.key = s.first;
+        member.key_size = s.second;
+        _members.push_back(member);
+    }
+
+
+
+    void on_start_array()
+    {
+        _frames.push_back({false, _elements.size()});
+    }
+
+
+
+    void on_end_array()
+    {
+        const auto base = _frames.back().base;
+        _frames.pop_back();
+        auto node = make_node(value_type::array);
+        node.size = checked_size(_elements.size() - base);
+        node.as.elements = move_to_arena(_elements, base);
+        add(node);
+    }
+
+
+
+    void on_start_object()
+    {
+        _frames.push_back({true, _members.size()});
+    }
+
+
+
+    void on_end_object()
+    {
+        const auto base = _frames.back().base;
+        _frames.pop_back();
+        auto node = make_node(value_type::object);
+        node.size = checked_size(_members.size() - base);
+        node.as.members = move_to_arena(_members, base);
+        add(node);
+    }
+
+
+
+    const document_node* finish()
+    {
+        return _root;
+    }
+
+
+
+private:
+    struct frame
+    {
+        bool is_object;
+        // Where the container's elements or members start on their stack.
+        size_t base;
+    };
+
+    arena& _arena;
+    intern_table* _table;
+    document_options _opts;
+    std::vector<frame> _frames;
+    std::vector<document_node> _elements;
+    std::vector<document_member> _members;
+    const document_node* _root = nullptr;
+
+
+
+    static document_node make_node(value_type type) noexcept
+    {
+        document_node node;
+        node.type = type;
+        node.size = 0;
+        return node;
+    }
+
+
+
+    void add(const document_node& node)
+    {
+        if (_frames.empty())
+        {
+            const auto root = _arena.allocate_array<document_node>(1);
+            *root = node;
+            _root = root;
+        }
+        else if (_frames.back().is_object)
+        {
+            _members.back().value = node;
+        }
+        else
+        {
+            _elements.push_back(node);
+        }
+    }
+
+
+
+    std::pair<const char*, uint32_t> copy_string(std::string_view s)
+    {
+        const auto size = checked_size(s.size());
+        const auto p = _arena.allocate_array<char>(size);
+        std::memcpy(p, s.data(), size);
+        return {p, size};
+    }
+
+
+
+    std::pair<const char*, uint32_t> intern_string(std::string_view s)
+    {
+        const auto interned = _table->intern(s);
+        return {interned.data(), checked_size(interned.size())};
+    }
+
+
+
+    template <typename T>
+    const T* move_to_arena(std::vector<T>& stack, size_t base)
+    {
+        const size_t n = stack.size() - base;
+        const auto p = _arena.allocate_array<T>(n);
+        if (n != 0)
+        {
+            std::memcpy(p, stack.data() + base, sizeof(T) * n);
+        }
+        stack.resize(base);
+        return p;
+    }
+
+
+
+    static uint32_t checked_size(size_t size)
+    {
+        if (std::numeric_limits<uint32_t>::max() < size)
+        {
+            JSON5_THROW(syntax_error{
+                "strings, arrays and objects in a document are limited to "
+                "2^32 - 1 bytes or elements"});
+        }
+        return static_cast<uint32_t>(size);
+    }
+};
+
+} // namespace detail
+} // namespace json5
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "./preprocessor.hpp"
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+
+
+namespace json5
+{
+namespace detail
+{
+
+/*
+ * A file opened for parsing. The contents of a regular file are viewed in
+ * memory: large files are mapped, so that they are neither copied nor held
+ * in memory twice, and small ones are read into a buffer, which costs less
+ * than setting up a mapping. Other files, such as pipes, have no known size
+ * and are meant to be read incrementally through descriptor().
+ *
+ * Mapping is not available on Windows, where files are always read.
+ */
+class input_file
+{
+public:
+    explicit input_file(const std::string& path)
+    {
+#if defined(_WIN32)
+        _fd = ::_open(path.c_str(), _O_RDONLY | _O_BINARY);
+#else
+        _fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+        if (_fd < 0)
+        {
+            JSON5_THROW(std::system_error{
+                errno, std::generic_category(), "failed to open " + path});
+        }
+
+#if defined(_WIN32)
+        struct _stat64 st;
+        const auto ret = ::_fstat64(_fd, &st);
+#else
+        struct stat st;
+        const auto ret = ::fstat(_fd, &st);
+#endif
+        if (ret != 0)
+        {
+            const auto error = errno;
+            close();
+            JSON5_THROW(std::system_error{
+                error, std::generic_category(), "failed to stat " + path});
+        }
+        _regular = (st.st_mode & S_IFMT) == S_IFREG;
+        _size = _regular ? static_cast<size_t>(st.st_size) : 0;
+    }
+
+
+
+    input_file(const input_file&) = delete;
+    input_file& operator=(const input_file&) = delete;
+
+
+
+    ~input_file()
+    {
+#if !defined(_WIN32)
+        if (_mapping)
+        {
+            ::munmap(_mapping, _size);
+        }
+#endif
+        close();
+    }
+
+
+
+    int descriptor() const noexcept
+    {
+        return _fd;
+    }
+
+
+
+    bool is_regular() const noexcept
+    {
+        return _regular;
+    }
+
+
+
+    // Only for regular files. The view is valid as long as this object.
+    std::string_view contents()
+    {
+#if !defined(_WIN32)
+        if (mmap_threshold <= _size)
+        {
+            const auto p =
+                ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+            // Some file systems cannot be mapped; they are read instead.
+            if (p != MAP_FAILED)
+            {
+                // Pages are read ahead more aggressively and dropped soon
+                // after they have been parsed.
+                ::madvise(p, _size, MADV_SEQUENTIAL);
+                _mapping = p;
+                return {static_cast<const char*>(_mapping), _size};
+            }
+        }
+#endif
+
+        // The file may change its size after fstat(); read it to the end.
+        _buffer.resize(_size + 1);
+        size_t length = 0;
+        while (true)
+        {
+            if (length == _buffer.size())
+            {
+                _buffer.resize(_buffer.size() * 2);
+            }
+            const auto n = read_some(&_buffer[length], _buffer.size() - length);
+            if (n == 0)
+                break;
+            length += n;
+        }
+        _buffer.resize(length);
+        return _buffer;
+    }
+
+
+
+private:
+    // Around this size, mapping and reading cost about the same.
+    static constexpr size_t mmap_threshold = 64 * 1024;
+
+    int _fd = -1;
+    bool _regular = false;
+    size_t _size = 0;
+    void* _mapping = nullptr;
+    std::string _buffer;
+
+
+
+    size_t read_some(char* buf, size_t size)
+    {
+        while (true)
+        {
+#if defined(_WIN32)
+            const auto n = ::_read(
+                _fd, buf, static_cast<unsigned int>(std::min<size_t>(
+                              size, INT32_MAX)));
+#else
+            const auto n = ::read(_fd, buf, size);
+#endif
+            if (0 <= n)
+                return static_cast<size_t>(n);
+            if (errno != EINTR)
+            {
+                JSON5_THROW(std::system_error{
+                    errno, std::generic_category(), "failed to read"});
+            }
+        }
+    }
+
+
+
+    void close() noexcept
+    {
+#if defined(_WIN32)
+        ::_close(_fd);
+#else
+        ::close(_fd);
+#endif
+    }
+};
+
+} // namespace detail
+} // namespace json5
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+
+
+namespace json5
+{
+namespace detail
+{
+
+/*
+ * Maps each key of a list fixed at compile time to the only position it may
+ * have in the list. The constructor, meant to run at compile time, searches
+ * for a seed which gives every key its own slot in a table of at least 8
+ * slots per key, so that a lookup costs one hash and one load, whatever the
+ * number of keys.
+ *
+ * Keys are first hashed by their length and three of their bytes, which
+ * tells most lists apart, then by all their bytes. If no seed works either
+ * way, for example because a key is listed twice, lookups compare the key
+ * with every entry instead.
+ */
+template <size_t N>
+class key_index
+{
+public:
+    constexpr explicit key_index(const std::array<std::string_view, N>& keys)
+        : _keys(keys)
+    {
+        for (const auto mode : {sampled, full})
+        {
+            for (uint32_t seed = 1; seed <= max_seeds; ++seed)
+            {
+                if (try_seed(mode, seed))
+                {
+                    _mode = mode;
+                    _seed = seed;
+                    return;
+                }
+            }
+        }
+        _mode = linear;
+    }
+
+
+
+    // Returns the position key has in the list if it is there, or N if it
+    // is known not to be. The caller compares key with the entry at the
+    // returned position.
+    constexpr size_t candidate(std::string_view key) const noexcept
+    {
+        if (_mode == linear)
+        {
+            for (size_t i = 0; i < N; ++i)
+            {
+                if (_keys[i] == key)
+                    return i;
+            }
+            return N;
+        }
+
+        const auto slot = _slots[hash(_mode, key, _seed)];
+        return slot == 0 ? N : size_t{slot} - 1u;
+    }
+
+
+
+private:
+    enum hash_mode
+    {
+        sampled,
+        full,
+        linear,
+    };
+
+    static constexpr uint32_t max_seeds = 1000;
+
+    static constexpr unsigned table_bits_for(size_t n) noexcept
+    {
+        unsigned bits = 3;
+        while ((size_t{1} << bits) < n * 8)
+        {
+            ++bits;
+        }
+        return bits;
+    }
+
+    static constexpr unsigned table_bits = table_bits_for(N);
+
+    std::array<std::string_view, N> _keys;
+    // Positions plus one; 0 for empty slots.
+    std::array<uint8_t, size_t{1} << table_bits> _slots{};
+    hash_mode _mode = linear;
+    uint32_t _seed = 0;
+
+
+
+    static constexpr uint32_t hash(
+        hash_mode mode,
+        std::string_view key,
+        uint32_t seed) noexcept
+    {
+        uint32_t h = static_cast<uint32_t>(key.size()) << 24;
+        if (mode == sampled)
+        {
+            if (!key.empty())
+            {
+                h ^= uint32_t{static_cast<uint8_t>(key[0])} |
+                    uint32_t{static_cast<uint8_t>(key[key.size() / 2])} << 8 |
+                    uint32_t{static_cast<uint8_t>(key.back())} << 16;
+            }
+        }
+        else
+        {
+            // FNV-1a
+            for (const auto c : key)
+            {
+                h = (h ^ static_cast<uint8_t>(c)) * 16777619u;
+            }
+        }
+        // Multiplicative hashing: the high bits of the product depend on all
+        // the bits of h.
+        return (h * (seed * 0x9e3779b8u + 1)) >> (32 - table_bits);
+    }
+
+
+
+    constexpr bool try_seed(hash_mode mode, uint32_t seed) noexcept
+    {
+        for (auto& s : _slots)
+        {
+            s = 0;
+        }
+        for (size_t i = 0; i < N; ++i)
+        {
+            auto& s = _slots[hash(mode, _keys[i], seed)];
+            if (s != 0)
+                return false;
+            s = static_cast<uint8_t>(i + 1);
+        }
+        return true;
+    }
+};
+
+} // namespace detail
+} // namespace json5
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <vector>
+#include "../exceptions.hpp"
+#include "./lexer.hpp"
+#include "./parser.hpp"
+#include "./preprocessor.hpp"
+#include "./simd.hpp"
+#include "./structural_indexer.hpp"
+#include "./util.hpp"
+
+
+
+namespace json5
+{
+namespace detail
+{
+
+// One entry per value and per object key, in source order.
+struct lazy_entry
+{
+    // Byte offset of the first character.
+    uint32_t offset;
+    // For arrays and objects, the index of the entry after the last one in
+    // them. Otherwise, the byte offset just past the value or key.
+    uint32_t extent;
+};
+
+
+
+/*
+ * Builds the structural index of a lazy document from the positions found by
+ * structural_indexer. It checks that brackets, colons and commas are where
+ * they should be, but scalars are only skipped: they are validated when they
+ * are decoded.
+ */
+class lazy_index_builder
+{
+public:
+    lazy_index_builder(std::string_view source)
+        : _source(source)
+        , _lexer(source)
+    {
+        if (std::numeric_limits<uint32_t>::max() < source.size())
+        {
+            JSON5_THROW(syntax_error{
+                "lazy documents are limited to 2^32 - 1 bytes of source"});
+        }
+    }
+
+
+
+    std::vector<lazy_entry> build()
+    {
+        const auto positions = structural_indexer{_source}.index();
+        auto state = expect::value;
+        for (size_t k = 0; k < positions.size(); ++k)
+        {
+            const auto pos = positions[k];
+            const auto c = _source[pos];
+            switch (state)
+            {
+            case expect::colon:
+                if (c != ':')
+                {
+                    JSON5_THROW(unexpected(pos, state));
+                }
+                state = expect::value;
+                break;
+            case expect::delimiter:
+                if (_open.empty())
+                {
+                    JSON5_THROW(unexpected(pos, state));
+                }
+                else if (c == ',')
+                {
+                    state = in_object() ? expect::key_or_close
+                                        : expect::value_or_close;
+                }
+                else if (c == (in_object() ? '}' : ']'))
+                {
+                    close();
+                }
+                else
+                {
+                    JSON5_THROW(unexpected(pos, state));
+                }
+                break;
+            case expect::key_or_close:
+                if (c == '}')
+                {
+                    close();
+                    state = expect::delimiter;
+                }
+                else if (c == '"' || c == '\'' || is_identifier_start(c))
+                {
+                    k = scalar(positions, k);
+                    state = expect::colon;
+                }
+                else
+                {
+                    JSON5_THROW(unexpected(pos, state));
+                }
+                break;
+            case expect::value_or_close:
+                if (c == ']')
+                {
+                    close();
+                    state = expect::delimiter;
+                    break;
+                }
+                [[fallthrough]];
+            case expect::value:
+                if (c == '[' || c == '{')
+                {
+                    // to_value() recurses into what it converts.
+                    if (_open.size() == max_depth)
+                    {
+                        JSON5_THROW(too_deep_error());
+                    }
+                    _open.push_back(static_cast<uint32_t>(_entries.size()));
+                    _entries.push_back({pos, 0});
+                    state = c == '[' ? expect::value_or_close
+                                     : expect::key_or_close;
+                }
+                else if (c == ']' || c == '}' || c == ':' || c == ',')
+                {
+                    JSON5_THROW(unexpected(pos, state));
+                }
+                else
+                {
+                    k = scalar(positions, k);
+                    state = expect::delimiter;
+                }
+                break;
+            }
+        }
+
+        if (!_open.empty() || state != expect::delimiter)
+        {
+            JSON5_THROW(unexpected(_source.size(), state));
+        }
+        return std::move(_entries);
+    }
+
+
+
+private:
+    enum class expect
+    {
+        value,
+        value_or_close,
+        key_or_close,
+        colon,
+        delimiter,
+    };
+
+    std::string_view _source;
+    // Used to skip numbers and literals, and to format error messages.
+    lexer _lexer;
+    std::vector<lazy_entry> _entries;
+    // Indices of the entries of the arrays and objects being indexed.
+    std::vector<uint32_t> _open;
+
+
+
+    bool in_object() const noexcept
+    {
+        return _source[_entries[_open.back()].offset] == '{';
+    }
+
+
+
+    // Returns the index of the last position which belongs to the scalar.
+    size_t scalar(const std::vector<uint32_t>& positions, size_t k)
+    {
+        const auto offset = positions[k];
+        if (_source[offset] == '"' || _source[offset] == '\'')
+        {
+            // The next position is the closing quote.
+            ++k;
+            _entries.push_back({offset, positions[k] + 1});
+            return k;
+        }
+
+        _lexer.seek(offset);
+        _lexer.skip_literal();
+        const auto end = _lexer.position();
+        // Stage 1 takes any run of bytes other than whitespaces and
+        // structural characters as one token.
+        const bool separated = end == _source.size() ||
+            is_whitespace(_source[end]) || _source[end] == '/' ||
+            (k + 1 < positions.size() && positions[k + 1] == end);
+        if (!separated)
+        {
+            JSON5_THROW(_lexer.invalid_char(expected(expect::delimiter)));
+        }
+        _entries.push_back({offset, static_cast<uint32_t>(end)});
+        return k;
+    }
+
+
+
+    void close()
+    {
+        _entries[_open.back()].extent = static_cast<uint32_t>(_entries.size());
+        _open.pop_back();
+    }
+
+
+
+    syntax_error unexpected(size_t pos, expect state)
+    {
+        _lexer.seek(pos);
+        return _lexer.invalid_char(expected(state));
+    }
+
+
+
+    const char* expected(expect state) const noexcept
+    {
+        switch (state)
+        {
+        case expect::value: return "any JSON5 value";
+        case expect::value_or_close: return "any JSON5 value or ']'";
+        case expect::key_or_close: return "string, identifier or '}'";
+        case expect::colon: return "':'";
+        default:
+            if (_open.empty())
+                return "EOF";
+            return in_object() ? "'}' or ','" : "']' or ','";
+        }
+    }
+};
+
+} // namespace detail
+} // namespace json5
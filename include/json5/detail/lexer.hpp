@@ -1,6 +1,13 @@
 #pragma once
 
+#include <cstdint>
+#include <string_view>
+#include "../dialect.hpp"
+#include "../error_code.hpp"
 #include "../exceptions.hpp"
+#include "./numeric.hpp"
+#include "./preprocessor.hpp"
+#include "./simd.hpp"
 #include "./token.hpp"
 #include "./util.hpp"
 
@@ -11,10 +18,18 @@ namespace json5
 namespace detail
 {
 
-class lexer
+/*
+ * Scans the syntax of Dialect; see dialect.hpp. Skipping and indexing, which
+ * the rest of the library does in the default dialect only, are not
+ * restricted by it. Errors are thrown as syntax_error, or, if RecordsErrors,
+ * recorded; see fail(). If not Decodes, escape sequences are checked but
+ * left as they are, so that strings are always slices of the source.
+ */
+template <typename Dialect, bool RecordsErrors = false, bool Decodes = true>
+class basic_lexer
 {
 public:
-    lexer(const std::string& source)
+    basic_lexer(std::string_view source)
         : _source(source)
         , _pos(0)
     {
@@ -25,6 +40,10 @@ public:
     token scan()
     {
         skip_whitespaces_and_comments();
+        if constexpr (RecordsErrors)
+        {
+            _token_start = _pos;
+        }
 
         if (eof())
             return token{token_type::eof};
@@ -34,97 +53,316 @@ public:
 
 
 
-private:
-    std::string _source;
-    size_t _pos;
+    /*
+     * Skips a value without decoding it, or the rest of one if depth
+     * brackets of it have already been consumed. Inside arrays and objects
+     * only brackets, strings and comments are looked at, so the skipped part
+     * is not validated; it is only guaranteed that brackets are balanced.
+     */
+    void skip_value(size_t depth)
+    {
+        const auto first = _source.data();
+        const auto last = first + _source.size();
+
+        if (depth == 0)
+        {
+            skip_whitespaces_and_comments();
+            const auto c = peek();
+            if (c == '"' || c == '\'')
+            {
+                skip_string();
+                return;
+            }
+            else if (c != '[' && c != '{')
+            {
+                skip_literal();
+                return;
+            }
+        }
+
+        while (true)
+        {
+            _pos = find_skip_special(first + _pos, last) - first;
+            if (eof())
+            {
+                fail(error_code::unexpected_end, "']' or '}'");
+                return;
+            }
+
+            switch (peek())
+            {
+            case '[':
+            case '{':
+                get();
+                ++depth;
+                break;
+            case ']':
+            case '}':
+                get();
+                if (--depth == 0)
+                    return;
+                break;
+            case '/':
+                if constexpr (!Dialect::comments)
+                {
+                    // Nothing else would move past it.
+                    fail(error_code::invalid_character, "']' or '}'");
+                    return;
+                }
+                skip_whitespaces_and_comments();
+                break;
+            default: skip_string(); break;
+            }
+        }
+    }
+
+
+
+    /*
+     * The rest of the public interface scans the source without decoding it.
+     * It is used to skip or index values.
+     */
+
+
+
+    size_t position() const noexcept
+    {
+        return _pos;
+    }
+
+
+
+    void seek(size_t pos) noexcept
+    {
+        _pos = pos;
+    }
+
+
+
+    bool eof() const
+    {
+        return _source.size() <= _pos;
+    }
+
+
+
+    char peek() const
+    {
+        // Unlike std::string, std::string_view has no null terminator to
+        // read past the end.
+        return eof() ? '\0' : _source[_pos];
+    }
+
+
+
+    char get()
+    {
+        const auto ret = _source[_pos];
+        ++_pos;
+        return ret;
+    }
 
 
 
     void skip_whitespaces_and_comments()
     {
-        if (eof())
+        const auto first = _source.data();
+        const auto last = first + _source.size();
+
+        if constexpr (!Dialect::comments)
+        {
+            _pos = skip_whitespaces(first + _pos, last) - first;
             return;
+        }
 
         while (true)
         {
-            const auto c = peek();
-            switch (c)
+            _pos = skip_whitespaces(first + _pos, last) - first;
+            if (eof() || peek() != '/')
+                return;
+
+            get();
+            if (eof())
             {
-            case '/':
+                fail(error_code::invalid_character, "'//' or '/*'");
+                return;
+            }
+
+            const auto k = peek();
+            if (k == '/')
             {
                 get();
-                if (eof())
-                {
-                    throw invalid_char("'//' or '/*'");
-                }
-
-                const auto k = peek();
-                if (k == '/')
+                _pos = find_line_break(first + _pos, last) - first;
+                if (!eof() && get() == '\r' && !eof() && peek() == '\n')
                 {
                     get();
-                    while (!eof())
-                    {
-                        const auto c = get();
-                        if (c == '\r')
-                        {
-                            if (!eof() && peek() == '\n')
-                            {
-                                get();
-                            }
-                            break;
-                        }
-                        else if (c == '\n')
-                        {
-                            break;
-                        }
-                    }
                 }
-                else if (k == '*')
-                {
-                    get();
-                    bool previos_char_is_asterisk = false;
-                    while (true)
-                    {
-                        if (eof())
-                        {
-                            throw invalid_char("'*/'");
-                        }
-
-                        const auto c = get();
-                        if (c == '*')
-                        {
-                            previos_char_is_asterisk = true;
-                        }
-                        else if (c == '/')
-                        {
-                            if (previos_char_is_asterisk)
-                            {
-                                break;
-                            }
-                        }
-                        else
-                        {
-                            previos_char_is_asterisk = false;
-                        }
-                    }
-                }
-                else
+            }
+            else if (k == '*')
+            {
+                get();
+                const auto end = find_block_comment_end(first + _pos, last);
+                if (!end)
                 {
-                    throw invalid_char("'//' or '/*'");
+                    const auto start = _pos - 2;
+                    _pos = _source.size();
+                    fail(error_code::unterminated_comment, start, [&] {
+                        return invalid_char("'*/'");
+                    });
+                    return;
                 }
+                _pos = end + 2 - first;
             }
-            break;
-            case ' ':
-            case '\t':
-            case '\r':
-            case '\n': get(); break;
-            default: return;
+            else
+            {
+                fail(error_code::invalid_character, "'//' or '/*'");
+                return;
+            }
+        }
+    }
+
+
+
+    void skip_string()
+    {
+        const auto first = _source.data();
+        const auto last = first + _source.size();
+        const size_t start = _pos;
+        const auto q = get(); // ' or "
+        while (true)
+        {
+            _pos = find_string_special(first + _pos, last, q) - first;
+            if (eof())
+            {
+                fail(error_code::unterminated_string, start, [&] {
+                    return invalid_char(q == '"' ? "'\"'" : "'");
+                });
+                return;
+            }
+
+            const auto c = get();
+            if (c == q)
+                return;
+            if (c == '\\' && !eof())
+            {
+                // The escaped character cannot close the string.
+                get();
+            }
+        }
+    }
+
+
+
+    // Skips a number, a literal or an identifier.
+    void skip_literal()
+    {
+        const size_t start = _pos;
+        while (!eof() &&
+               (is_identifier_continue(peek()) || peek() == '+' ||
+                peek() == '-' || peek() == '.'))
+        {
+            get();
+        }
+        if (_pos == start)
+        {
+            fail(error_code::invalid_character, "any JSON5 value");
+        }
+    }
+
+
+
+    syntax_error invalid_char(const char* expected_char)
+    {
+        return syntax_error{std::string{"expected "} + expected_char +
+                            ", but actually got " +
+                            get_current_char_for_error_message() + "."};
+    }
+
+
+
+    /*
+     * Reports an error found at pos, with make_error() building the
+     * exception to throw. If RecordsErrors, nothing is thrown or built:
+     * the first error is recorded, and the lexer moves to the end of the
+     * source, so that every token scanned afterwards is EOF.
+     */
+    template <typename MakeError>
+    void fail(error_code code, size_t pos, MakeError&& make_error)
+    {
+        if constexpr (RecordsErrors)
+        {
+            if (_error == error_code::ok)
+            {
+                _error = code;
+                _error_offset = pos;
             }
+            _pos = _source.size();
         }
+        else
+        {
+            JSON5_THROW(make_error());
+        }
+    }
+
+
+
+    // Reports an unexpected character at the current position.
+    void fail(error_code code, const char* expected_char)
+    {
+        fail(code, _pos, [&] { return invalid_char(expected_char); });
+    }
+
+
+
+    // Whether an error has been recorded.
+    bool failed() const noexcept
+    {
+        return RecordsErrors && _error != error_code::ok;
+    }
+
+
+
+    error_code error() const noexcept
+    {
+        return _error;
     }
 
 
 
+    size_t error_offset() const noexcept
+    {
+        return _error_offset;
+    }
+
+
+
+    // Where the last token scanned starts, if RecordsErrors.
+    size_t token_start() const noexcept
+    {
+        return _token_start;
+    }
+
+
+
+private:
+    // Takes the place of the decoded string if not Decodes.
+    struct discarded_string
+    {
+        void operator+=(char) noexcept
+        {
+        }
+    };
+
+    std::string_view _source;
+    size_t _pos;
+    // Scratch space for decoded strings. It is reused across tokens.
+    std::string _buffer;
+    error_code _error = error_code::ok;
+    size_t _error_offset = 0;
+    size_t _token_start = 0;
+
+
+
     token scan_internal()
     {
         const auto c = peek();
@@ -136,8 +374,12 @@ private:
         case '}': get(); return token{token_type::brace_right};
         case ':': get(); return token{token_type::colon};
         case ',': get(); return token{token_type::comma};
-        case '\'':
         case '"': return scan_string();
+        case '\'':
+            // Reported as an invalid character otherwise.
+            if constexpr (Dialect::single_quotes)
+                return scan_string();
+            return scan_numeric_or_identifier();
         default: return scan_numeric_or_identifier();
         }
     }
@@ -146,13 +388,37 @@ private:
 
     token scan_string()
     {
-        std::string s;
+        const auto first = _source.data();
+        const auto last = first + _source.size();
         const auto q = get(); // ' or "
+        const size_t start = _pos;
+        // Strings without any escape sequence are returned as a slice of the
+        // source. Once an escape sequence appears, the string is decoded into
+        // _buffer instead.
+        bool escaped = false;
         while (true)
         {
+            // Jump over the run of ordinary characters.
+            const size_t run_start = _pos;
+            if constexpr (Dialect::control_characters)
+            {
+                _pos = find_string_special(first + _pos, last, q) - first;
+            }
+            else
+            {
+                _pos = find_json_string_special(first + _pos, last) - first;
+            }
+            if (escaped)
+            {
+                _buffer.append(first + run_start, _pos - run_start);
+            }
+
             if (eof())
             {
-                throw invalid_char(q == '"' ? "'\"'" : "'");
+                fail(error_code::unterminated_string, start - 1, [&] {
+                    return invalid_char(q == '"' ? "'\"'" : "'");
+                });
+                return token{token_type::eof};
             }
 
             const auto c = get();
@@ -162,34 +428,61 @@ private:
             }
             else if (c == '\r' || c == '\n')
             {
-                const char* br;
-                if (!eof() && peek() == '\n')
-                {
-                    br = "\\r\\n";
-                }
-                else if (c == '\r')
-                {
-                    br = "\\r";
-                }
-                else
-                {
-                    br = "\\n";
-                }
-                throw syntax_error{
-                    std::string{"raw line break cannot be included in string "
-                                "literals, use '"} +
-                    br + "'"};
+                fail(error_code::invalid_string_character, _pos - 1, [&] {
+                    const char* br;
+                    if (c == '\r' && !eof() && peek() == '\n')
+                    {
+                        br = "\\r\\n";
+                    }
+                    else if (c == '\r')
+                    {
+                        br = "\\r";
+                    }
+                    else
+                    {
+                        br = "\\n";
+                    }
+                    return syntax_error{
+                        std::string{"raw line break cannot be included in "
+                                    "string literals, use '"} +
+                        br + "'"};
+                });
+                return token{token_type::eof};
+            }
+            else if (!Dialect::control_characters && c != '\\')
+            {
+                --_pos;
+                fail(error_code::invalid_string_character, "escape sequence");
+                return token{token_type::eof};
             }
-            else if (c == '\\')
+            else if constexpr (!Decodes)
             {
-                s += scan_escape_sequence();
+                // c is '\\'.
+                discarded_string out;
+                scan_escape_sequence(out);
             }
             else
             {
-                s += c;
+                // c is '\\'.
+                if (!escaped)
+                {
+                    _buffer.assign(first + start, _pos - 1 - start);
+                    escaped = true;
+                }
+                // If it fails, the next run stops at the end of the source.
+                scan_escape_sequence(_buffer);
             }
         }
-        return token{token_type::string, s};
+
+        if (escaped)
+        {
+            return token{token_type::string, _buffer};
+        }
+        else
+        {
+            return token{
+                token_type::string, _source.substr(start, _pos - 1 - start)};
+        }
     }
 
 
@@ -208,45 +501,64 @@ private:
      * | \v | vertical tab    | U+000B |
      * | \0 | null            | U+0000 |
      * +----+-----------------+--------+
+     *
+     * The decoded character is appended to out.
      */
-    std::string scan_escape_sequence()
+    template <typename String>
+    void scan_escape_sequence(String& out)
     {
         if (eof())
         {
-            throw invalid_char("escape sequence");
+            fail(error_code::invalid_escape, "escape sequence");
+            return;
+        }
+
+        if constexpr (!Dialect::json5_escapes)
+        {
+            switch (peek())
+            {
+            case '"':
+            case '\\':
+            case '/':
+            case 'b':
+            case 'f':
+            case 'n':
+            case 'r':
+            case 't':
+            case 'u': break;
+            default:
+                fail(error_code::invalid_escape, "escape sequence");
+                return;
+            }
         }
 
         const auto c = get();
         switch (c)
         {
-        case '\'': return "'";
-        case '"': return "\"";
-        case '\\': return "\\";
-        case 'b': return "\b";
-        case 'f': return "\f";
-        case 'n': return "\n";
-        case 'r': return "\r";
-        case 't': return "\t";
-        case 'v': return "\v";
+        case '\'': out += '\''; break;
+        case '"': out += '"'; break;
+        case '\\': out += '\\'; break;
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        case 't': out += '\t'; break;
+        case 'v': out += '\v'; break;
         case '0':
             if (is_digit(peek()))
             {
-                throw syntax_error{
-                    "C-style octal character literal is not allowed except for "
-                    "'\\0'. Use "
-                    "prefix \\x or \\u"};
-            }
-            else
-            {
-                return "\0";
+                fail_octal_escape();
+                return;
             }
+            out += '\0';
+            break;
         case '\r':
             if (peek() == '\n')
             {
                 get();
             }
-            return ""; // skip the line break.
-        case '\n': return ""; // skip the line break.
+            break; // skip the line break.
+        case '\n': break; // skip the line break.
         case '1':
         case '2':
         case '3':
@@ -255,69 +567,76 @@ private:
         case '6':
         case '7':
         case '8':
-        case '9':
-            throw syntax_error{
-                "C-style octal character literal is not allowed except for "
-                "'\\0'. Use "
-                "prefix \\x or \\u"};
+        case '9': fail_octal_escape(); return;
         case 'x':
         {
             // \xNN (N: a hexadecimal digit)
             // U+0000 - U+00FF
-            char32_t codepoint = escape_sequence_codepoint(2);
+            const char32_t codepoint = escape_sequence_codepoint(2);
             if (is_hex_digit(peek()))
             {
-                throw syntax_error{
-                    "Escape sequence prefixed by '\\x' must be followed by "
-                    "only two hexadecimal digits, but got third one."};
+                fail(error_code::invalid_escape, _pos, [&] {
+                    return syntax_error{
+                        "Escape sequence prefixed by '\\x' must be followed by "
+                        "only two hexadecimal digits, but got third one."};
+                });
+                return;
             }
-            return codepoint_to_string(codepoint);
+            append_codepoint_as_utf8(out, codepoint);
+            break;
         }
         case 'u':
         {
             // \uNNNN (N: a hexadecimal digit)
             // U+0000 - U+FFFF
-            char32_t first = escape_sequence_codepoint(4);
-            if (is_hex_digit(peek()))
+            char32_t codepoint = escape_sequence_codepoint(4);
+            if (is_surrogate_pair_first(codepoint))
             {
-                throw syntax_error{
-                    "Escape sequence prefixed by '\\u' must be followed by "
-                    "only four hexadecimal digits, but got fifth one."};
-            }
-            if (peek() == '\\')
-            {
-                // Surrogate pair?
+                // It must be followed by the second part, \uDC00 - \uDFFF.
+                if (peek() != '\\')
+                {
+                    fail(
+                        error_code::invalid_escape,
+                        "second part of surrogate pair");
+                    return;
+                }
                 get();
-                if (peek() == 'u')
+                if (peek() != 'u')
                 {
-                    // They are a surrogate pair.
-                    char32_t second = escape_sequence_codepoint(4);
-                    if (is_hex_digit(peek()))
-                    {
-                        throw syntax_error{
-                            "Escape sequence prefixed by '\\u' must be "
-                            "followed by "
-                            "only four hexadecimal digits, but got fifth one."};
-                    }
-                    return codepoint_to_string(
-                        surrogate_pair_to_codepoint(first, second));
+                    fail(
+                        error_code::invalid_escape,
+                        "second part of surrogate pair");
+                    return;
                 }
-                else
+                get();
+                const char32_t second = escape_sequence_codepoint(4);
+                if (!is_surrogate_pair_second(second))
                 {
-                    if (is_surrogate_pair_first(first))
-                    {
-                        throw invalid_char("second part of surrogate pair");
-                    }
-                    // Not surrogate pair, next escape sequence.
-                    return codepoint_to_string(first) + scan_escape_sequence();
+                    fail(error_code::invalid_escape, _pos - 6, [&] {
+                        return syntax_error{
+                            "expected second part of surrogate pair (\\uDC00 "
+                            "- \\uDFFF), but actually got \\u" +
+                            codepoint_to_hex_digit_string(second) + "."};
+                    });
+                    return;
                 }
+                codepoint = surrogate_pair_to_codepoint(
+                    static_cast<char16_t>(codepoint),
+                    static_cast<char16_t>(second));
             }
-            else
+            if (is_hex_digit(peek()))
             {
-                return codepoint_to_string(first);
+                fail(error_code::invalid_escape, _pos, [&] {
+                    return syntax_error{
+                        "Escape sequence prefixed by '\\u' must be followed by "
+                        "only four hexadecimal digits, but got fifth one."};
+                });
+                return;
             }
+            append_codepoint_as_utf8(out, codepoint);
+            break;
         }
-        default: return std::string{1, c};
+        default: out += c; break;
         }
     }
 
@@ -385,7 +704,7 @@ private:
         bool starts_with_decimal_point = false;
         size_t start = _pos;
 
-        if (peek() == '+')
+        if (Dialect::leading_plus && peek() == '+')
         {
             get();
             ++start;
@@ -406,14 +725,36 @@ private:
                 return token{integer_type{0}};
             }
 
-            if (peek() == 'x' || peek() == 'X')
+            if (Dialect::hexadecimal && (peek() == 'x' || peek() == 'X'))
             {
                 get();
+                const size_t digits_start = _pos;
                 consume_hexadecial_integer();
-                return static_cast<integer_type>(
-                    std::stoll(_source.substr(start), 0, 16));
+                if (failed())
+                    return token{token_type::eof};
+
+                integer_type n;
+                if (!parse_hexadecimal_integer(
+                        _source.data() + digits_start,
+                        _source.data() + _pos,
+                        sign < 0,
+                        n))
+                {
+                    return fail_out_of_range(start);
+                }
+                return token{n};
             }
 
+            if constexpr (!Dialect::leading_zeros)
+            {
+                if (is_digit(peek()))
+                {
+                    fail(
+                        error_code::invalid_number,
+                        "'.', exponent or end of number");
+                    return token{token_type::eof};
+                }
+            }
             while (!eof())
             {
                 if (is_digit(peek()))
@@ -440,7 +781,7 @@ private:
                 }
             }
         }
-        else if (c == '.')
+        else if (Dialect::bare_decimal_point && c == '.')
         {
             starts_with_decimal_point = true;
         }
@@ -450,8 +791,12 @@ private:
         }
         else
         {
-            throw syntax_error{"invalid character, " +
-                               get_current_char_for_error_message()};
+            fail(error_code::invalid_character, _pos, [&] {
+                return syntax_error{
+                    "invalid character, " +
+                    get_current_char_for_error_message()};
+            });
+            return token{token_type::eof};
         }
 
         bool has_decimal_point = false;
@@ -471,23 +816,39 @@ private:
                     break;
                 }
             }
-            if (starts_with_decimal_point && !has_any_digit)
+            if ((starts_with_decimal_point || !Dialect::bare_decimal_point) &&
+                !has_any_digit)
             {
-                throw invalid_char("any digit");
+                fail(error_code::invalid_number, "any digit");
+                return token{token_type::eof};
             }
             has_decimal_point = true;
         }
 
         bool has_exponent = consume_exponent();
+        if (failed())
+            return token{token_type::eof};
+
+        const auto first = _source.data() + start;
+        const auto last = _source.data() + _pos;
         if (has_decimal_point || has_exponent)
         {
-            return token{
-                static_cast<number_type>(std::stold(_source.substr(start), 0))};
+            number_type d;
+            if (!parse_floating_point(first, last, d))
+            {
+                return fail_out_of_range(start);
+            }
+            return token{d};
         }
         else
         {
-            return token{static_cast<integer_type>(
-                std::stoll(_source.substr(start), 0))};
+            integer_type n;
+            if (!parse_decimal_integer(
+                    sign < 0 ? first + 1 : first, last, sign < 0, n))
+            {
+                return fail_out_of_range(start);
+            }
+            return token{n};
         }
     }
 
@@ -506,7 +867,8 @@ private:
             }
             else
             {
-                throw invalid_char(s);
+                fail(error_code::invalid_character, s);
+                return;
             }
         }
     }
@@ -530,7 +892,9 @@ private:
         }
         if (!has_any_digit)
         {
-            throw invalid_char("hexadecimal digit (0-9, a-f or A-F)");
+            fail(
+                error_code::invalid_number,
+                "hexadecimal digit (0-9, a-f or A-F)");
         }
     }
 
@@ -547,7 +911,8 @@ private:
         get();
         if (eof())
         {
-            throw invalid_char("digit");
+            fail(error_code::invalid_number, "digit");
+            return false;
         }
         if (peek() == '+' || peek() == '-')
         {
@@ -556,7 +921,7 @@ private:
         bool has_any_digit = false;
         while (!eof())
         {
-            if (is_hex_digit(peek()))
+            if (is_digit(peek()))
             {
                 get();
                 has_any_digit = true;
@@ -568,7 +933,8 @@ private:
         }
         if (!has_any_digit)
         {
-            throw invalid_char("any digit");
+            fail(error_code::invalid_number, "any digit");
+            return false;
         }
 
         return true;
@@ -578,24 +944,25 @@ private:
 
     token scan_identifier(int8_t sign)
     {
-        string_type name;
+        const size_t start = _pos;
         while (!eof())
         {
             if (is_identifier_continue(peek()))
             {
-                name += get();
+                get();
             }
             else
             {
                 break;
             }
         }
+        const auto name = _source.substr(start, _pos - start);
 
         // Check special literals.
         switch (name[0])
         {
         case 'I':
-            if (name == "Infinity")
+            if (Dialect::infinity_and_nan && name == "Infinity")
             {
                 if (sign)
                 {
@@ -608,7 +975,7 @@ private:
             }
             break;
         case 'N':
-            if (name == "NaN")
+            if (Dialect::infinity_and_nan && name == "NaN")
             {
                 if (sign)
                 {
@@ -625,8 +992,7 @@ private:
             {
                 if (sign)
                 {
-                    throw syntax_error{
-                        "expected any number, but actually got 'null'"};
+                    return fail_signed_literal(start, "'null'");
                 }
                 else
                 {
@@ -639,8 +1005,7 @@ private:
             {
                 if (sign)
                 {
-                    throw syntax_error{
-                        "expected any number, but actually got 'true'"};
+                    return fail_signed_literal(start, "'true'");
                 }
                 else
                 {
@@ -653,8 +1018,7 @@ private:
             {
                 if (sign)
                 {
-                    throw syntax_error{
-                        "expected any number, but actually got 'false'"};
+                    return fail_signed_literal(start, "'false'");
                 }
                 else
                 {
@@ -678,8 +1042,12 @@ private:
             const auto c = peek();
             if (!is_hex_digit(c))
             {
-                throw invalid_char("hexadecimal digit (0-9, a-f or A-F)");
+                fail(
+                    error_code::invalid_escape,
+                    "hexadecimal digit (0-9, a-f or A-F)");
+                return ret;
             }
+            get();
             ret = ret * 16 + hex_digit_char_to_integer(c);
         }
         return ret;
@@ -687,42 +1055,54 @@ private:
 
 
 
-    char peek() const
+    syntax_error out_of_range(size_t start)
     {
-        return _source[_pos];
+        return syntax_error{
+            "numeric literal is out of range: " +
+            std::string{_source.substr(start, _pos - start)}};
     }
 
 
 
-    char get()
+    token fail_out_of_range(size_t start)
     {
-        const auto ret = _source[_pos];
-        ++_pos;
-        return ret;
+        fail(error_code::number_out_of_range, start, [&] {
+            return out_of_range(start);
+        });
+        return token{token_type::eof};
     }
 
 
 
-    bool eof() const
+    // Reports a sign before null, true or false, the identifier at start.
+    token fail_signed_literal(size_t start, const char* literal)
     {
-        return _source.size() <= _pos;
+        fail(error_code::invalid_number, start, [&] {
+            return syntax_error{
+                std::string{"expected any number, but actually got "} +
+                literal};
+        });
+        return token{token_type::eof};
     }
 
 
 
-    std::string format_char(char c)
+    void fail_octal_escape()
     {
-        // TODO
-        return std::string(1, c);
+        fail(error_code::invalid_escape, _pos - 1, [&] {
+            return syntax_error{
+                "C-style octal character literal is not allowed except for "
+                "'\\0'. Use "
+                "prefix \\x or \\u"};
+        });
     }
 
 
 
-    syntax_error invalid_char(const char* expected_char)
+    std::string format_char(char c)
     {
-        return syntax_error{std::string{"expected "} + expected_char +
-                            ", but actually got " +
-                            get_current_char_for_error_message() + "."};
+        // TODO
+        return std::string(1, c);
     }
 
 
@@ -734,7 +1114,7 @@ private:
 
         const size_t start = _pos;
         const size_t end = start + byte_count_utf8(_source[_pos]);
-        if (_source.size() <= end)
+        if (_source.size() < end)
             return "<Invalid UTF-8>";
 
         switch (end - start)
@@ -799,19 +1179,27 @@ private:
 
 
 
-class token_stream
+template <typename Dialect, bool RecordsErrors = false, bool Decodes = true>
+class basic_token_stream
 {
 public:
-    token_stream(const std::string& source)
+    basic_token_stream(std::string_view source)
         : _lexer(source)
+        , _has_lookahead(false)
     {
-        get();
     }
 
 
 
-    token peek()
+    // The next token is scanned lazily so that the token returned by get()
+    // stays valid until the next call to peek() or get().
+    const token& peek()
     {
+        if (!_has_lookahead)
+        {
+            _lookahead = _lexer.scan();
+            _has_lookahead = true;
+        }
         return _lookahead;
     }
 
@@ -819,17 +1207,65 @@ public:
 
     token get()
     {
-        const auto ret = _lookahead;
-        _lookahead = _lexer.scan();
-        return ret;
+        peek();
+        _has_lookahead = false;
+        return _lookahead;
+    }
+
+
+
+    // See lexer::skip_value(). It must not be called after peek().
+    void skip_value(size_t depth)
+    {
+        _lexer.skip_value(depth);
+    }
+
+
+
+    /*
+     * Reports an error in the last token scanned; see lexer::fail(). The
+     * lookahead is dropped, so that only EOF follows a recorded error.
+     */
+    template <typename MakeError>
+    void fail(error_code code, MakeError&& make_error)
+    {
+        _lexer.fail(code, _lexer.token_start(), make_error);
+        _has_lookahead = false;
+    }
+
+
+
+    bool failed() const noexcept
+    {
+        return _lexer.failed();
+    }
+
+
+
+    error_code error() const noexcept
+    {
+        return _lexer.error();
+    }
+
+
+
+    size_t error_offset() const noexcept
+    {
+        return _lexer.error_offset();
     }
 
 
 
 private:
-    lexer _lexer;
+    basic_lexer<Dialect, RecordsErrors, Decodes> _lexer;
     token _lookahead;
+    bool _has_lookahead;
 };
 
+
+
+using lexer = basic_lexer<json5_extended_dialect>;
+using token_stream = basic_token_stream<json5_extended_dialect>;
+
 } // namespace detail
 } // namespace json5
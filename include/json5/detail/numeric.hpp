@@ -0,0 +1,266 @@
+#pragma once
+
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <charconv>
+#include <limits>
+#include <string>
+#include <system_error>
+#include "../types.hpp"
+#include "./util.hpp"
+
+
+
+namespace json5
+{
+namespace detail
+{
+
+/*
+ * Conversion of numeric lexemes which have already been validated by the
+ * lexer. They return false if the value does not fit in the destination type.
+ * As long as std::from_chars for floating point is available, none of them
+ * allocate or depend on the current locale.
+ */
+
+
+
+// [first, last) consists only of decimal digits.
+inline bool parse_decimal_integer(
+    const char* first,
+    const char* last,
+    bool negative,
+    integer_type& out) noexcept
+{
+    constexpr uint64_t max_positive =
+        static_cast<uint64_t>(std::numeric_limits<integer_type>::max());
+    const uint64_t limit = negative ? max_positive + 1 : max_positive;
+
+    uint64_t n = 0;
+    for (const char* p = first; p != last; ++p)
+    {
+        const uint64_t d = static_cast<uint64_t>(*p - '0');
+        if (n > (limit - d) / 10)
+        {
+            return false;
+        }
+        n = n * 10 + d;
+    }
+
+    if (negative)
+    {
+        // -(2^63) cannot be negated as a signed integer.
+        out = n == max_positive + 1 ? std::numeric_limits<integer_type>::min()
+                                    : -static_cast<integer_type>(n);
+    }
+    else
+    {
+        out = static_cast<integer_type>(n);
+    }
+    return true;
+}
+
+
+
+// [first, last) consists only of hexadecimal digits, without the "0x" prefix.
+inline bool parse_hexadecimal_integer(
+    const char* first,
+    const char* last,
+    bool negative,
+    integer_type& out) noexcept
+{
+    constexpr uint64_t max_positive =
+        static_cast<uint64_t>(std::numeric_limits<integer_type>::max());
+    const uint64_t limit = negative ? max_positive + 1 : max_positive;
+
+    uint64_t n = 0;
+    for (const char* p = first; p != last; ++p)
+    {
+        if (n > (limit >> 4))
+        {
+            return false;
+        }
+        n = (n << 4) | hex_digit_char_to_integer(*p);
+        if (n > limit)
+        {
+            return false;
+        }
+    }
+
+    if (negative)
+    {
+        out = n == max_positive + 1 ? std::numeric_limits<integer_type>::min()
+                                    : -static_cast<integer_type>(n);
+    }
+    else
+    {
+        out = static_cast<integer_type>(n);
+    }
+    return true;
+}
+
+
+
+/*
+ * [first, last) matches
+ *   '-'? Digit* ('.' Digit*)? (('e' | 'E') ('+' | '-')? Digit+)?
+ * with at least one digit in the mantissa.
+ *
+ * Most literals written by hand or by a shortest round-trip printer have at
+ * most 15 significant digits and a small exponent. They are converted exactly
+ * by a single multiplication or division (Clinger's fast path). Everything
+ * else goes to std::from_chars, which is correctly rounded.
+ */
+inline bool parse_floating_point(
+    const char* first,
+    const char* last,
+    number_type& out) noexcept
+{
+    static constexpr number_type powers_of_ten[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+
+    const char* p = first;
+    const bool negative = *p == '-';
+    if (negative)
+    {
+        ++p;
+    }
+
+    uint64_t mantissa = 0;
+    int significant_digits = 0;
+    // Decimal exponent of the least significant digit stored in mantissa.
+    int64_t exponent = 0;
+    // Number of integral digits, ignoring leading zeros. It estimates the
+    // magnitude if from_chars reports the result out of range.
+    int64_t integral_digits = 0;
+    bool truncated = false;
+
+    for (; p != last && is_digit(*p); ++p)
+    {
+        if (mantissa == 0 && *p == '0')
+        {
+            continue;
+        }
+        ++integral_digits;
+        if (significant_digits < 19)
+        {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+            ++significant_digits;
+        }
+        else
+        {
+            ++exponent;
+            truncated = truncated || *p != '0';
+        }
+    }
+    if (p != last && *p == '.')
+    {
+        ++p;
+        for (; p != last && is_digit(*p); ++p)
+        {
+            if (mantissa == 0 && *p == '0')
+            {
+                --exponent;
+                --integral_digits;
+                continue;
+            }
+            if (significant_digits < 19)
+            {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                ++significant_digits;
+                --exponent;
+            }
+            else
+            {
+                truncated = truncated || *p != '0';
+            }
+        }
+    }
+    if (p != last && (*p == 'e' || *p == 'E'))
+    {
+        ++p;
+        bool negative_exponent = false;
+        if (*p == '+' || *p == '-')
+        {
+            negative_exponent = *p == '-';
+            ++p;
+        }
+        int64_t e = 0;
+        for (; p != last; ++p)
+        {
+            // Saturate; anything this large is out of range anyway.
+            if (e < 100000)
+            {
+                e = e * 10 + (*p - '0');
+            }
+        }
+        exponent += negative_exponent ? -e : e;
+        integral_digits += negative_exponent ? -e : e;
+    }
+
+    if (mantissa == 0)
+    {
+        out = negative ? -0.0 : 0.0;
+        return true;
+    }
+
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    if (!truncated && mantissa <= (uint64_t{1} << 53) && -22 <= exponent &&
+        exponent <= 22)
+    {
+        auto d = static_cast<number_type>(mantissa);
+        if (exponent < 0)
+        {
+            d /= powers_of_ten[-exponent];
+        }
+        else
+        {
+            d *= powers_of_ten[exponent];
+        }
+        out = negative ? -d : d;
+        return true;
+    }
+#endif
+
+    number_type d;
+#if defined(__cpp_lib_to_chars)
+    const auto result = std::from_chars(first, last, d);
+    const bool out_of_range = result.ec == std::errc::result_out_of_range;
+#else
+    // Lexemes longer than this are rare enough to pay for an allocation.
+    char buf[64];
+    std::string long_lexeme;
+    const char* s;
+    if (static_cast<size_t>(last - first) < sizeof(buf))
+    {
+        std::copy(first, last, buf);
+        buf[last - first] = '\0';
+        s = buf;
+    }
+    else
+    {
+        long_lexeme.assign(first, last);
+        s = long_lexeme.c_str();
+    }
+    d = std::strtod(s, nullptr);
+    const bool out_of_range = std::abs(d) == HUGE_VAL || d == 0;
+#endif
+    if (out_of_range)
+    {
+        if (0 < integral_digits)
+        {
+            return false;
+        }
+        // Underflow rounds to zero.
+        d = negative ? -0.0 : 0.0;
+    }
+    out = d;
+    return true;
+}
+
+} // namespace detail
+} // namespace json5
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <utility>
+
+
+
+namespace json5
+{
+namespace detail
+{
+
+/*
+ * Collects the members of an object being parsed. Containers for which
+ * one-by-one insertion is expensive specialize this to build themselves in
+ * bulk once all members are known.
+ */
+template <typename Object>
+struct object_builder
+{
+    Object object;
+
+
+
+    template <typename K, typename V>
+    void add(K&& k, V&& v)
+    {
+        // The first occurrence of a duplicated key wins.
+        object.emplace(std::forward<K>(k), std::forward<V>(v));
+    }
+
+
+
+    Object finish()
+    {
+        return std::move(object);
+    }
+};
+
+} // namespace detail
+} // namespace json5
@@ -1,137 +1,424 @@
 #pragma once
 
+#include <bitset>
+#include <string>
+#include <vector>
 #include "../value.hpp"
 #include "./lexer.hpp"
 #include "./util.hpp"
 
 
 
+/*
+ * JSON5_MAX_DEPTH is how deeply arrays and objects may be nested. Deeper
+ * sources fail to parse with error_code::too_deep. The parser itself uses
+ * no stack frame per level, but values are destroyed, copied and stringified
+ * recursively, so the limit must leave room for that on the call stack.
+ */
+#if !defined(JSON5_MAX_DEPTH)
+#define JSON5_MAX_DEPTH 1000
+#endif
+
+
+
 namespace json5
 {
 namespace detail
 {
 
+constexpr size_t max_depth = JSON5_MAX_DEPTH;
+
+
+
+inline syntax_error too_deep_error()
+{
+    return syntax_error{"arrays and objects are nested deeper than " +
+                        std::to_string(max_depth)};
+}
+
+
+
+/*
+ * Whether each open array or object is an object, one bit per level. The
+ * first levels are held in place, so that usual sources are parsed without
+ * allocating, and deeper ones on the heap, so that a large JSON5_MAX_DEPTH
+ * does not make the parser large.
+ */
+class nesting_stack
+{
+public:
+    bool get(size_t depth) const noexcept
+    {
+        if (depth < inline_depth)
+            return _inline[depth];
+
+        return _heap[depth - inline_depth];
+    }
+
+
+
+    void set(size_t depth, bool object)
+    {
+        if (depth < inline_depth)
+        {
+            _inline[depth] = object;
+            return;
+        }
+        depth -= inline_depth;
+        if (_heap.size() <= depth)
+        {
+            _heap.resize(depth + 1);
+        }
+        _heap[depth] = object;
+    }
+
+
+
+private:
+    static constexpr size_t inline_depth = max_depth < 1024 ? max_depth : 1024;
+
+    std::bitset<inline_depth> _inline;
+    std::vector<bool> _heap;
+};
+
+
+
+inline syntax_error parse_error(
+    const detail::token& actual_token,
+    const char* expected_token)
+{
+    return syntax_error{std::string{"expect "} + expected_token +
+                        ", but actually " + actual_token.to_string()};
+}
+
+
+
+/*
+ * Checks the syntax of Dialect and reports what it reads to the handler as
+ * events. See json5::sax_handler for the events. Nothing is kept once it has
+ * been reported, so memory use does not depend on the size of the source.
+ *
+ * Values are parsed in a loop, and the open arrays and objects are kept on
+ * a nesting_stack, so deeply nested sources cannot overflow the call stack.
+ *
+ * If RecordsErrors, the first error is recorded instead of being thrown, and
+ * the parser stops there; see error(). The handler is then left in the
+ * middle of a value. If not Decodes, strings are reported undecoded; see
+ * basic_lexer.
+ */
+template <
+    typename Handler,
+    typename Dialect = json5_extended_dialect,
+    bool RecordsErrors = false,
+    bool Decodes = true>
 class parser
 {
 public:
-    parser(const std::string& source)
+    parser(std::string_view source, Handler& handler)
         : _ts(source)
+        , _handler(handler)
     {
     }
 
 
 
-    value parse()
+    void parse()
     {
-        return parse_value();
+        parse_value();
     }
 
 
 
-private:
-    token_stream _ts;
+    /*
+     * Parses a run of array elements separated by commas, up to the end of
+     * the source, and reports it as one array. If last, the run is the end
+     * of its array: it may be empty or end with a comma.
+     */
+    void parse_elements(bool last)
+    {
+        // The elements are inside an array, as they are in parse().
+        _stack.set(_depth++, false);
+        _handler.on_start_array();
+        if (!last || _ts.peek().type() != token_type::eof)
+        {
+            while (true)
+            {
+                parse_value();
+                const auto delimiter = _ts.get();
+                if (delimiter.type() == token_type::eof)
+                {
+                    break;
+                }
+                else if (delimiter.type() != token_type::comma)
+                {
+                    fail(delimiter, "',' or EOF");
+                    return;
+                }
+                if (Dialect::trailing_commas && last &&
+                    _ts.peek().type() == token_type::eof)
+                {
+                    break;
+                }
+            }
+        }
+        --_depth;
+        _handler.on_end_array();
+    }
 
 
 
-    value parse_value()
+    // Checks that nothing but whitespaces and comments follows the value.
+    void expect_eof()
     {
         const auto tok = _ts.get();
-        switch (tok.type())
+        if (tok.type() != token_type::eof)
         {
-        case token_type::bracket_left: return parse_array();
-        case token_type::brace_left: return parse_object();
-        case token_type::null: return value{};
-        case token_type::true_: return value{true};
-        case token_type::false_: return value{false};
-        case token_type::infinity: return value{infinity()};
-        case token_type::nan: return value{nan()};
-        case token_type::integer: return value{tok.get_integer()};
-        case token_type::number: return value{tok.get_number()};
-        case token_type::string: return value{tok.get_string()};
-        default: throw parse_error(tok, "any JSON5 value");
+            fail(tok, "EOF");
         }
     }
 
 
 
-    value parse_array()
+    // The first error, if RecordsErrors, or error_code::ok.
+    error_code error() const noexcept
+    {
+        return _ts.error();
+    }
+
+
+
+    // The byte offset of the first error in the source.
+    size_t error_offset() const noexcept
     {
-        // The open bracket '[' has been consumed by the caller.
-        value::array_type array;
+        return _ts.error_offset();
+    }
+
+
+
+private:
+    basic_token_stream<Dialect, RecordsErrors, Decodes> _ts;
+    Handler& _handler;
+    // The open arrays and objects.
+    nesting_stack _stack;
+    size_t _depth = 0;
+
+
+
+    // Reports that tok, the last token scanned, is not the expected one.
+    void fail(const token& tok, const char* expected_token)
+    {
+        const auto code = tok.type() == token_type::eof
+            ? error_code::unexpected_end
+            : error_code::unexpected_token;
+        _ts.fail(code, [&] { return parse_error(tok, expected_token); });
+    }
+
+
+
+    void parse_value()
+    {
+        // The arrays and objects around the value. Those opened while parsing
+        // it are all closed when it is complete.
+        const auto base = _depth;
         while (true)
         {
-            if (_ts.peek().type() == token_type::eof)
-            {
-                throw parse_error(
-                    token{token_type::eof}, "any JSON5 value or ']'");
-            }
-            else if (_ts.peek().type() == token_type::bracket_right)
+            const auto tok = _ts.get();
+            bool opened = false;
+            switch (tok.type())
             {
-                _ts.get();
+            case token_type::bracket_left:
+            case token_type::brace_left:
+                if (!open(tok.type() == token_type::brace_left))
+                    return;
+                opened = true;
+                break;
+            case token_type::null: _handler.on_null(); break;
+            case token_type::true_: _handler.on_boolean(true); break;
+            case token_type::false_: _handler.on_boolean(false); break;
+            case token_type::infinity: _handler.on_number(infinity()); break;
+            case token_type::nan: _handler.on_number(nan()); break;
+            case token_type::integer:
+                _handler.on_integer(tok.get_integer());
                 break;
+            case token_type::number:
+                _handler.on_number(tok.get_number());
+                break;
+            case token_type::string:
+                _handler.on_string(tok.get_string());
+                break;
+            default: fail(tok, "any JSON5 value"); return;
             }
+            if (!next_value(base, opened))
+                return;
+        }
+    }
 
-            array.push_back(parse_value());
 
-            const auto delimiter = _ts.get();
-            if (delimiter.type() == token_type::bracket_right)
-            {
-                break;
-            }
-            else if (delimiter.type() != token_type::comma)
-            {
-                throw parse_error(delimiter, "']' or ','");
-            }
+
+    // Opens an array or object whose bracket has been read, unless that
+    // nests it too deep.
+    bool open(bool object)
+    {
+        if (_depth == max_depth)
+        {
+            _ts.fail(error_code::too_deep, [] { return too_deep_error(); });
+            return false;
+        }
+        _stack.set(_depth++, object);
+        if (object)
+        {
+            _handler.on_start_object();
         }
-        return array;
+        else
+        {
+            _handler.on_start_array();
+        }
+        return true;
     }
 
 
 
-    value parse_object()
+    /*
+     * Reads past the end of a value, or past the bracket which has just
+     * opened an array or object, closing every array and object which ends
+     * there. Returns whether a value follows; false once the arrays and
+     * objects above base are all closed, or on an error.
+     */
+    bool next_value(size_t base, bool opened)
     {
-        // The open brace '{' has been consumed by the caller.
-        value::object_type object;
-        while (true)
+        while (_depth != base)
+        {
+            const bool value_follows = _stack.get(_depth - 1)
+                ? next_member(opened)
+                : next_element(opened);
+            if (value_follows || _ts.failed())
+                return value_follows;
+
+            opened = false;
+        }
+        return false;
+    }
+
+
+
+    // Returns whether an element follows; false once the array is closed.
+    bool next_element(bool opened)
+    {
+        if (!opened)
         {
-            if (_ts.peek().type() == token_type::eof)
+            const auto delimiter = _ts.get();
+            if (delimiter.type() == token_type::bracket_right)
             {
-                throw parse_error(
-                    token{token_type::eof}, "any JSON5 value or '}'");
+                --_depth;
+                _handler.on_end_array();
+                return false;
             }
-            else if (_ts.peek().type() == token_type::brace_right)
+            else if (delimiter.type() != token_type::comma)
             {
-                _ts.get();
-                break;
+                fail(delimiter, "']' or ','");
+                return false;
             }
 
-            const auto k = parse_key();
-            const auto kv_separator = _ts.get();
-            if (kv_separator.type() != token_type::colon)
+            if constexpr (!Dialect::trailing_commas)
             {
-                throw parse_error(kv_separator, "':'");
+                if (_ts.peek().type() == token_type::bracket_right)
+                {
+                    fail(_ts.peek(), "any JSON5 value");
+                    return false;
+                }
             }
-            const auto v = parse_value();
-            object.emplace(k, v);
+        }
 
+        if (_ts.peek().type() == token_type::eof)
+        {
+            fail(token{token_type::eof}, "any JSON5 value or ']'");
+            return false;
+        }
+        else if (_ts.peek().type() == token_type::bracket_right)
+        {
+            _ts.get();
+            --_depth;
+            _handler.on_end_array();
+            return false;
+        }
+        return true;
+    }
+
+
+
+    // Same as next_element(), for the members of an object. Their keys are
+    // read as well.
+    bool next_member(bool opened)
+    {
+        if (!opened)
+        {
             const auto delimiter = _ts.get();
             if (delimiter.type() == token_type::brace_right)
             {
-                break;
+                --_depth;
+                _handler.on_end_object();
+                return false;
             }
             else if (delimiter.type() != token_type::comma)
             {
-                throw parse_error(delimiter, "'}' or ','");
+                fail(delimiter, "'}' or ','");
+                return false;
+            }
+
+            if constexpr (!Dialect::trailing_commas)
+            {
+                if (_ts.peek().type() == token_type::brace_right)
+                {
+                    fail(_ts.peek(), "string");
+                    return false;
+                }
             }
         }
-        return object;
+
+        if (_ts.peek().type() == token_type::eof)
+        {
+            fail(token{token_type::eof}, "any JSON5 value or '}'");
+            return false;
+        }
+        else if (_ts.peek().type() == token_type::brace_right)
+        {
+            _ts.get();
+            --_depth;
+            _handler.on_end_object();
+            return false;
+        }
+
+        // The key may point to the lexer's buffer, so it is reported before
+        // the next token is read.
+        const auto key = parse_key();
+        if (_ts.failed())
+            return false;
+
+        _handler.on_key(key);
+        const auto kv_separator = _ts.get();
+        if (kv_separator.type() != token_type::colon)
+        {
+            fail(kv_separator, "':'");
+            return false;
+        }
+        return true;
     }
 
 
 
-    string_type parse_key()
+    std::string_view parse_key()
     {
         const auto tok = _ts.get();
+        if constexpr (!Dialect::identifier_keys)
+        {
+            if (tok.type() != token_type::string)
+            {
+                fail(tok, "string");
+                return {};
+            }
+            return tok.get_string();
+        }
+
         switch (tok.type())
         {
         case token_type::null: return "null";
@@ -141,19 +428,9 @@ private:
         case token_type::nan: return "NaN";
         case token_type::string:
         case token_type::identifier: return tok.get_string();
-        default: throw parse_error(tok, "string or identifier");
+        default: fail(tok, "string or identifier"); return {};
         }
     }
-
-
-
-    syntax_error parse_error(
-        const detail::token& actual_token,
-        const char* expected_token)
-    {
-        return syntax_error{std::string{"expect "} + expected_token +
-                            ", but actually " + actual_token.to_string()};
-    }
 };
 
 } // namespace detail
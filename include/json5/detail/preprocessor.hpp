@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cstdlib>
+
+
+
+/*
+ * JSON5_THROW(e) throws e. When exceptions are disabled, as by
+ * -fno-exceptions, it aborts instead, and JSON5_TRY and JSON5_CATCH reduce
+ * the handlers to dead code; try_parse() still reports errors. The operand of
+ * sizeof is not evaluated; it only keeps what e refers to from being unused.
+ */
+
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define JSON5_EXCEPTIONS 1
+#define JSON5_THROW(...) throw __VA_ARGS__
+#define JSON5_TRY try
+#define JSON5_CATCH(...) catch (__VA_ARGS__)
+#else
+#define JSON5_EXCEPTIONS 0
+#define JSON5_THROW(...) \
+    (static_cast<void>(sizeof(__VA_ARGS__)), std::abort())
+#define JSON5_TRY if (true)
+#define JSON5_CATCH(...) if (false)
+#endif
+
+
+
+/*
+ * JSON5_FOR_EACH(m, x, a, b, ...) expands to m(x, a), m(x, b), ... for up to
+ * 64 arguments. JSON5_EXPAND forces the extra rescan needed by the
+ * traditional MSVC preprocessor, which passes __VA_ARGS__ as one argument.
+ */
+
+#define JSON5_EXPAND(x) x
+#define JSON5_CONCAT(a, b) JSON5_CONCAT_IMPL(a, b)
+#define JSON5_CONCAT_IMPL(a, b) a##b
+
+#define JSON5_COUNT(...) \
+    JSON5_EXPAND(JSON5_COUNT_IMPL( \
+        __VA_ARGS__, 64, 63, 62, 61, 60, 59, 58, 57, 56, 55, 54, 53, 52, 51, \
+        50, 49, 48, 47, 46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36, 35, 34, \
+        33, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, \
+        16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1))
+#define JSON5_COUNT_IMPL( \
+    _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, \
+    _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, \
+    _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, \
+    _42, _43, _44, _45, _46, _47, _48, _49, _50, _51, _52, _53, _54, _55, _56, \
+    _57, _58, _59, _60, _61, _62, _63, _64, n, ...) \
+    n
+
+#define JSON5_FOR_EACH(m, x, ...) \
+    JSON5_EXPAND(JSON5_CONCAT(JSON5_FOR_EACH_, JSON5_COUNT(__VA_ARGS__))( \
+        m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_1(m, x, a) m(x, a)
+#define JSON5_FOR_EACH_2(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_1(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_3(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_2(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_4(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_3(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_5(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_4(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_6(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_5(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_7(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_6(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_8(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_7(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_9(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_8(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_10(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_9(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_11(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_10(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_12(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_11(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_13(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_12(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_14(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_13(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_15(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_14(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_16(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_15(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_17(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_16(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_18(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_17(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_19(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_18(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_20(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_19(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_21(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_20(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_22(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_21(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_23(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_22(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_24(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_23(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_25(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_24(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_26(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_25(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_27(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_26(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_28(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_27(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_29(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_28(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_30(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_29(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_31(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_30(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_32(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_31(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_33(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_32(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_34(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_33(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_35(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_34(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_36(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_35(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_37(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_36(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_38(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_37(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_39(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_38(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_40(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_39(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_41(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_40(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_42(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_41(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_43(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_42(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_44(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_43(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_45(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_44(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_46(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_45(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_47(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_46(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_48(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_47(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_49(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_48(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_50(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_49(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_51(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_50(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_52(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_51(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_53(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_52(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_54(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_53(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_55(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_54(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_56(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_55(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_57(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_56(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_58(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_57(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_59(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_58(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_60(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_59(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_61(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_60(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_62(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_61(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_63(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_62(m, x, __VA_ARGS__))
+#define JSON5_FOR_EACH_64(m, x, a, ...) \
+    m(x, a), JSON5_EXPAND(JSON5_FOR_EACH_63(m, x, __VA_ARGS__))
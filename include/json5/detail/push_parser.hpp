@@ -0,0 +1,212 @@
+#pragma once
+
+#include <vector>
+#include "./parser.hpp"
+#include "./preprocessor.hpp"
+#include "./token.hpp"
+#include "./util.hpp"
+
+
+
+namespace json5
+{
+namespace detail
+{
+
+/*
+ * Parser which is given one token at a time instead of pulling tokens from
+ * a lexer. Open arrays and objects are kept on an explicit stack, so the
+ * whole state lives in this object and parsing can stop and resume between
+ * any two tokens. Events and error messages are the same as parser's.
+ */
+template <typename Handler>
+class push_parser
+{
+public:
+    explicit push_parser(Handler& handler)
+        : _handler(handler)
+    {
+    }
+
+
+
+    void push(const token& tok)
+    {
+        switch (_expect)
+        {
+        case expect::value: value(tok); break;
+        case expect::value_or_close:
+            if (tok.type() == token_type::bracket_right)
+            {
+                close();
+            }
+            else if (tok.type() == token_type::eof)
+            {
+                JSON5_THROW(parse_error(tok, "any JSON5 value or ']'"));
+            }
+            else
+            {
+                value(tok);
+            }
+            break;
+        case expect::key_or_close: key_or_close(tok); break;
+        case expect::colon:
+            if (tok.type() != token_type::colon)
+            {
+                JSON5_THROW(parse_error(tok, "':'"));
+            }
+            _expect = expect::value;
+            break;
+        case expect::delimiter:
+        {
+            const bool in_object = _stack.back();
+            if (tok.type() == token_type::comma)
+            {
+                _expect =
+                    in_object ? expect::key_or_close : expect::value_or_close;
+            }
+            else if (
+                tok.type() == (in_object ? token_type::brace_right
+                                         : token_type::bracket_right))
+            {
+                close();
+            }
+            else
+            {
+                JSON5_THROW(parse_error(
+                    tok, in_object ? "'}' or ','" : "']' or ','"));
+            }
+            break;
+        }
+        default:
+            if (tok.type() != token_type::eof)
+            {
+                JSON5_THROW(parse_error(tok, "EOF"));
+            }
+            break;
+        }
+    }
+
+
+
+    // Whether the top-level value has been completed.
+    bool done() const noexcept
+    {
+        return _expect == expect::eof;
+    }
+
+
+
+    // Number of arrays and objects currently open.
+    size_t depth() const noexcept
+    {
+        return _stack.size();
+    }
+
+
+
+private:
+    enum class expect
+    {
+        value,
+        value_or_close,
+        key_or_close,
+        colon,
+        delimiter,
+        eof,
+    };
+
+    Handler& _handler;
+    // true for an object, false for an array.
+    std::vector<bool> _stack;
+    expect _expect = expect::value;
+
+
+
+    void value(const token& tok)
+    {
+        switch (tok.type())
+        {
+        case token_type::bracket_left: open(false); return;
+        case token_type::brace_left: open(true); return;
+        case token_type::null: _handler.on_null(); break;
+        case token_type::true_: _handler.on_boolean(true); break;
+        case token_type::false_: _handler.on_boolean(false); break;
+        case token_type::infinity: _handler.on_number(infinity()); break;
+        case token_type::nan: _handler.on_number(nan()); break;
+        case token_type::integer: _handler.on_integer(tok.get_integer()); break;
+        case token_type::number: _handler.on_number(tok.get_number()); break;
+        case token_type::string: _handler.on_string(tok.get_string()); break;
+        default: JSON5_THROW(parse_error(tok, "any JSON5 value"));
+        }
+        after_value();
+    }
+
+
+
+    void key_or_close(const token& tok)
+    {
+        switch (tok.type())
+        {
+        case token_type::brace_right: close(); return;
+        case token_type::eof:
+            JSON5_THROW(parse_error(tok, "any JSON5 value or '}'"));
+        case token_type::null: _handler.on_key("null"); break;
+        case token_type::true_: _handler.on_key("true"); break;
+        case token_type::false_: _handler.on_key("false"); break;
+        case token_type::infinity: _handler.on_key("Infinity"); break;
+        case token_type::nan: _handler.on_key("NaN"); break;
+        case token_type::string:
+        case token_type::identifier: _handler.on_key(tok.get_string()); break;
+        default: JSON5_THROW(parse_error(tok, "string or identifier"));
+        }
+        _expect = expect::colon;
+    }
+
+
+
+    void open(bool object)
+    {
+        if (_stack.size() == max_depth)
+        {
+            JSON5_THROW(too_deep_error());
+        }
+        if (object)
+        {
+            _handler.on_start_object();
+            _expect = expect::key_or_close;
+        }
+        else
+        {
+            _handler.on_start_array();
+            _expect = expect::value_or_close;
+        }
+        _stack.push_back(object);
+    }
+
+
+
+    void close()
+    {
+        if (_stack.back())
+        {
+            _handler.on_end_object();
+        }
+        else
+        {
+            _handler.on_end_array();
+        }
+        _stack.pop_back();
+        after_value();
+    }
+
+
+
+    void after_value()
+    {
+        _expect = _stack.empty() ? expect::eof : expect::delimiter;
+    }
+};
+
+} // namespace detail
+} // namespace json5
@@ -0,0 +1,366 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#if !defined(JSON5_DISABLE_SIMD)
+#if defined(__AVX2__)
+#define JSON5_SIMD_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JSON5_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+
+namespace json5
+{
+namespace detail
+{
+
+inline uint32_t count_trailing_zeros(uint32_t n) noexcept
+{
+    // n must not be zero.
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanForward(&i, n);
+    return static_cast<uint32_t>(i);
+#else
+    return static_cast<uint32_t>(__builtin_ctz(n));
+#endif
+}
+
+
+
+inline uint32_t count_trailing_zeros(uint64_t n) noexcept
+{
+    // n must not be zero.
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long i;
+    _BitScanForward64(&i, n);
+    return static_cast<uint32_t>(i);
+#elif defined(_MSC_VER)
+    const auto low = static_cast<uint32_t>(n);
+    return low ? count_trailing_zeros(low)
+               : 32 + count_trailing_zeros(static_cast<uint32_t>(n >> 32));
+#else
+    return static_cast<uint32_t>(__builtin_ctzll(n));
+#endif
+}
+
+
+
+/*
+ * byte_block is a chunk of input processed at once. Each comparison returns
+ * a bit mask in which the i-th bit corresponds to the i-th byte.
+ */
+#if defined(JSON5_SIMD_AVX2)
+
+struct byte_block
+{
+    static constexpr size_t size = 32;
+
+    __m256i v;
+
+
+
+    static byte_block load(const char* p) noexcept
+    {
+        return {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))};
+    }
+
+
+
+    uint32_t eq(char c) const noexcept
+    {
+        return static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(c))));
+    }
+
+
+
+    // Bytes below c, compared as unsigned. c must be in [1, 0x80].
+    uint32_t lt(uint8_t c) const noexcept
+    {
+        // v is below c where min(v, c - 1) is v.
+        const auto m = _mm256_set1_epi8(static_cast<char>(c - 1));
+        return static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_min_epu8(v, m), v)));
+    }
+};
+
+#elif defined(JSON5_SIMD_SSE2)
+
+struct byte_block
+{
+    static constexpr size_t size = 16;
+
+    __m128i v;
+
+
+
+    static byte_block load(const char* p) noexcept
+    {
+        return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))};
+    }
+
+
+
+    uint32_t eq(char c) const noexcept
+    {
+        return static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c))));
+    }
+
+
+
+    // Bytes below c, compared as unsigned. c must be in [1, 0x80].
+    uint32_t lt(uint8_t c) const noexcept
+    {
+        // v is below c where min(v, c - 1) is v.
+        const auto m = _mm_set1_epi8(static_cast<char>(c - 1));
+        return static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(v, m), v)));
+    }
+};
+
+#else
+
+// Portable fallback: 8 bytes at a time in a general-purpose register.
+struct byte_block
+{
+    static constexpr size_t size = 8;
+
+    uint64_t v;
+
+
+
+    static byte_block load(const char* p) noexcept
+    {
+        // Assembled in little-endian order so that byte i is p[i] on any
+        // platform. Compilers turn this into a single load.
+        uint64_t v = 0;
+        for (size_t i = 0; i < size; ++i)
+        {
+            v |= static_cast<uint64_t>(static_cast<uint8_t>(p[i])) << (i * 8);
+        }
+        return {v};
+    }
+
+
+
+    uint32_t eq(char c) const noexcept
+    {
+        constexpr uint64_t low7 = 0x7F7F'7F7F'7F7F'7F7Full;
+        const uint64_t x =
+            v ^ (0x0101'0101'0101'0101ull * static_cast<uint8_t>(c));
+        // 0x80 in each byte of x which is zero, without false positives.
+        const uint64_t zero = ~(((x & low7) + low7) | x | low7);
+        return gather(zero);
+    }
+
+
+
+    // Bytes below c, compared as unsigned. c must be in [1, 0x80].
+    uint32_t lt(uint8_t c) const noexcept
+    {
+        constexpr uint64_t low7 = 0x7F7F'7F7F'7F7F'7F7Full;
+        // The high bit of each byte of t is set where the low 7 bits of the
+        // byte of v are at least c, without carries between bytes.
+        const uint64_t t =
+            (v & low7) + 0x0101'0101'0101'0101ull * (0x80u - c);
+        return gather(~(t | v) & ~low7);
+    }
+
+
+
+private:
+    // Gathers the high bit of each byte of x into the low byte.
+    static uint32_t gather(uint64_t x) noexcept
+    {
+        return static_cast<uint32_t>(
+            ((x >> 7) * 0x0102'0408'1020'4080ull) >> 56);
+    }
+};
+
+#endif
+
+
+
+constexpr uint32_t full_mask() noexcept
+{
+    return byte_block::size == 32
+        ? 0xFFFF'FFFFu
+        : static_cast<uint32_t>((uint64_t{1} << byte_block::size) - 1);
+}
+
+
+
+inline bool is_whitespace(char c) noexcept
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+
+
+// Returns the first byte in [p, last) which is not whitespace, or last.
+inline const char* skip_whitespaces(const char* p, const char* last) noexcept
+{
+    // Tokens are mostly separated by nothing or a single space.
+    if (p == last || !is_whitespace(*p))
+        return p;
+
+    for (; byte_block::size <= static_cast<size_t>(last - p);
+         p += byte_block::size)
+    {
+        const auto b = byte_block::load(p);
+        const auto m = ~(b.eq(' ') | b.eq('\t') | b.eq('\r') | b.eq('\n')) &
+            full_mask();
+        if (m)
+            return p + count_trailing_zeros(m);
+    }
+    for (; p != last; ++p)
+    {
+        if (!is_whitespace(*p))
+            return p;
+    }
+    return last;
+}
+
+
+
+// Returns the first '\r' or '\n' in [p, last), or last.
+inline const char* find_line_break(const char* p, const char* last) noexcept
+{
+    for (; byte_block::size <= static_cast<size_t>(last - p);
+         p += byte_block::size)
+    {
+        const auto b = byte_block::load(p);
+        const auto m = b.eq('\r') | b.eq('\n');
+        if (m)
+            return p + count_trailing_zeros(m);
+    }
+    for (; p != last; ++p)
+    {
+        if (*p == '\r' || *p == '\n')
+            return p;
+    }
+    return last;
+}
+
+
+
+// Returns the first "*/" in [p, last), or nullptr.
+inline const char* find_block_comment_end(
+    const char* p,
+    const char* last) noexcept
+{
+    // Compares each byte with '*' and its successor with '/' using two
+    // overlapping loads.
+    for (; byte_block::size < static_cast<size_t>(last - p);
+         p += byte_block::size)
+    {
+        const auto m = byte_block::load(p).eq('*') &
+            byte_block::load(p + 1).eq('/');
+        if (m)
+            return p + count_trailing_zeros(m);
+    }
+    for (; p != last && p + 1 != last; ++p)
+    {
+        if (p[0] == '*' && p[1] == '/')
+            return p;
+    }
+    return nullptr;
+}
+
+
+
+// Returns the first quote q, '\\', '\r' or '\n' in [p, last), or last.
+inline const char* find_string_special(
+    const char* p,
+    const char* last,
+    char q) noexcept
+{
+    for (; byte_block::size <= static_cast<size_t>(last - p);
+         p += byte_block::size)
+    {
+        const auto b = byte_block::load(p);
+        const auto m = b.eq(q) | b.eq('\\') | b.eq('\r') | b.eq('\n');
+        if (m)
+            return p + count_trailing_zeros(m);
+    }
+    for (; p != last; ++p)
+    {
+        const auto c = *p;
+        if (c == q || c == '\\' || c == '\r' || c == '\n')
+            return p;
+    }
+    return last;
+}
+
+
+
+// Returns the first '"', '\\' or control character in [p, last), or last.
+// Control characters include line breaks.
+inline const char* find_json_string_special(
+    const char* p,
+    const char* last) noexcept
+{
+    for (; byte_block::size <= static_cast<size_t>(last - p);
+         p += byte_block::size)
+    {
+        const auto b = byte_block::load(p);
+        const auto m = b.eq('"') | b.eq('\\') | b.lt(0x20);
+        if (m)
+            return p + count_trailing_zeros(m);
+    }
+    for (; p != last; ++p)
+    {
+        const auto c = static_cast<uint8_t>(*p);
+        if (c == '"' || c == '\\' || c < 0x20)
+            return p;
+    }
+    return last;
+}
+
+
+
+// Returns the first bracket, brace, quote or '/' in [p, last), or last. These
+// are the only bytes which matter when a value is skipped without decoding.
+inline const char* find_skip_special(const char* p, const char* last) noexcept
+{
+    for (; byte_block::size <= static_cast<size_t>(last - p);
+         p += byte_block::size)
+    {
+        const auto b = byte_block::load(p);
+        const auto m = b.eq('[') | b.eq(']') | b.eq('{') | b.eq('}') |
+            b.eq('"') | b.eq('\'') | b.eq('/');
+        if (m)
+            return p + count_trailing_zeros(m);
+    }
+    for (; p != last; ++p)
+    {
+        switch (*p)
+        {
+        case '[':
+        case ']':
+        case '{':
+        case '}':
+        case '"':
+        case '\'':
+        case '/': return p;
+        default: break;
+        }
+    }
+    return last;
+}
+
+} // namespace detail
+} // namespace json5
@@ -0,0 +1,287 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+#include "./simd.hpp"
+
+
+
+namespace json5
+{
+namespace detail
+{
+
+/*
+ * Helpers to split a source into parts which are parsed independently, for
+ * example on different threads. They only look at brackets, commas and line
+ * breaks outside strings and comments, and do not validate anything: a
+ * malformed source is split somewhere, and the error is reported by the
+ * parser of the part it ends up in.
+ */
+
+
+
+// Returns the first byte after the comment which starts at p, or p + 1 if
+// the '/' starts none. The line break after a line comment is not skipped.
+inline const char* skip_comment_for_split(
+    const char* p,
+    const char* last) noexcept
+{
+    if (last - p < 2)
+        return last;
+
+    if (p[1] == '/')
+        return find_line_break(p + 2, last);
+
+    if (p[1] == '*')
+    {
+        const auto end = find_block_comment_end(p + 2, last);
+        return end ? end + 2 : last;
+    }
+    return p + 1;
+}
+
+
+
+// Bits of the bytes of p[0, 64) which may matter when splitting: brackets,
+// braces, quotes, '\\', '/', ',' and '\n'.
+inline uint64_t split_special_mask(const char* p) noexcept
+{
+    uint64_t m = 0;
+    for (size_t i = 0; i < 64; i += byte_block::size)
+    {
+        const auto b = byte_block::load(p + i);
+        m |= uint64_t{b.eq('[') | b.eq(']') | b.eq('{') | b.eq('}') |
+                      b.eq('"') | b.eq('\'') | b.eq('\\') | b.eq('/') |
+                      b.eq(',') | b.eq('\n')}
+            << i;
+    }
+    return m;
+}
+
+
+
+/*
+ * Calls visit(p) for each bracket, brace, ',' and '\n' in [p, last) outside
+ * strings and comments, until visit returns false. A raw line break ends a
+ * string as well, since strings cannot contain one.
+ *
+ * The source is classified 64 bytes at a time, and only the bits of the
+ * block are walked, so each byte which matters costs a few instructions.
+ */
+template <typename Visitor>
+void visit_structure(const char* p, const char* last, Visitor&& visit)
+{
+    // The quote of the string being skipped, or '\0'.
+    char quote = '\0';
+    // Bytes before this one have been consumed by an escape sequence.
+    const char* resume = p;
+    while (p != last)
+    {
+        uint64_t m;
+        if (64 <= last - p)
+        {
+            m = split_special_mask(p);
+        }
+        else
+        {
+            // Padded with spaces, which do not matter.
+            char buf[64];
+            std::memset(buf, ' ', sizeof(buf));
+            std::memcpy(buf, p, static_cast<size_t>(last - p));
+            m = split_special_mask(buf);
+        }
+
+        const char* next = p + std::min<ptrdiff_t>(64, last - p);
+        for (; m; m &= m - 1)
+        {
+            const auto q = p + count_trailing_zeros(m);
+            if (q < resume)
+                continue;
+
+            const auto c = *q;
+            if (quote)
+            {
+                if (c == quote)
+                {
+                    quote = '\0';
+                }
+                else if (c == '\\')
+                {
+                    // The escaped character, or line break, cannot end the
+                    // string.
+                    resume = q + 2;
+                    if (resume < last && q[1] == '\r' && q[2] == '\n')
+                    {
+                        ++resume;
+                    }
+                }
+                else if (c == '\n')
+                {
+                    quote = '\0';
+                    if (!visit(q))
+                        return;
+                }
+                continue;
+            }
+
+            switch (c)
+            {
+            case '"':
+            case '\'': quote = c; break;
+            case '\\': break;
+            case '/':
+                // Resumes from the end of the comment.
+                next = skip_comment_for_split(q, last);
+                m = 0;
+                break;
+            default:
+                if (!visit(q))
+                    return;
+                break;
+            }
+            if (!m)
+                break;
+        }
+        p = std::max(next, std::min(resume, last));
+    }
+}
+
+
+
+// Returns the first byte in [p, last) which is not a whitespace or in a
+// comment, or last.
+inline const char* skip_blank(const char* p, const char* last) noexcept
+{
+    while (true)
+    {
+        p = skip_whitespaces(p, last);
+        if (p == last || *p != '/' || last - p < 2 ||
+            (p[1] != '/' && p[1] != '*'))
+        {
+            return p;
+        }
+        p = skip_comment_for_split(p, last);
+    }
+}
+
+
+
+// Whether [p, last) contains nothing but whitespaces and comments.
+inline bool is_blank(const char* p, const char* last) noexcept
+{
+    return skip_blank(p, last) == last;
+}
+
+
+
+/*
+ * Splits a JSON5 Lines source into records. Records are separated by '\n'
+ * outside arrays, objects, strings and comments, so one record may span
+ * several lines. Lines with only whitespaces and comments are skipped.
+ */
+inline std::vector<std::string_view> split_lines(std::string_view source)
+{
+    std::vector<std::string_view> records;
+    const auto first = source.data();
+    const auto last = first + source.size();
+    auto start = first;
+    size_t depth = 0;
+
+    const auto add = [&](const char* end) {
+        if (!is_blank(start, end))
+        {
+            records.emplace_back(start, static_cast<size_t>(end - start));
+        }
+    };
+    visit_structure(first, last, [&](const char* p) {
+        switch (*p)
+        {
+        case '[':
+        case '{': ++depth; break;
+        case ']':
+        case '}':
+            if (depth != 0)
+            {
+                --depth;
+            }
+            break;
+        case '\n':
+            if (depth == 0)
+            {
+                add(p);
+                start = p + 1;
+            }
+            break;
+        default: break;
+        }
+        return true;
+    });
+    add(last);
+    return records;
+}
+
+
+
+/*
+ * Splits the elements of a top-level array into runs of about
+ * source.size() / parts bytes each, at the commas between elements. The
+ * runs exclude the brackets of the array and the commas they are split at.
+ * Returns no run if the source is not an array or the array is not closed.
+ */
+inline std::vector<std::string_view> split_array(
+    std::string_view source,
+    size_t parts)
+{
+    std::vector<std::string_view> runs;
+    const auto first = source.data();
+    const auto last = first + source.size();
+    const auto open = skip_blank(first, last);
+    if (open == last || *open != '[')
+        return runs;
+
+    const auto step = source.size() / parts;
+    auto start = open + 1;
+    auto target = start + step;
+    size_t depth = 1;
+    bool closed = false;
+    visit_structure(start, last, [&](const char* p) {
+        switch (*p)
+        {
+        case '[':
+        case '{': ++depth; break;
+        case ']':
+        case '}':
+            if (--depth == 0)
+            {
+                closed = *p == ']';
+                runs.emplace_back(start, static_cast<size_t>(p - start));
+                return false;
+            }
+            break;
+        case ',':
+            if (depth == 1 && target <= p)
+            {
+                runs.emplace_back(start, static_cast<size_t>(p - start));
+                start = p + 1;
+                target = p + step;
+            }
+            break;
+        default: break;
+        }
+        return true;
+    });
+
+    if (!closed)
+    {
+        runs.clear();
+    }
+    return runs;
+}
+
+} // namespace detail
+} // namespace json5
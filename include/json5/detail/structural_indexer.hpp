@@ -0,0 +1,396 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+#include "../exceptions.hpp"
+#include "./lexer.hpp"
+#include "./preprocessor.hpp"
+#include "./simd.hpp"
+
+
+
+namespace json5
+{
+namespace detail
+{
+
+/*
+ * Finds, in one vectorized pass over the source, the positions of
+ *
+ * - the structural characters {}[]:, outside strings and comments,
+ * - the opening and closing quotes of each string, and
+ * - the first byte of each number and literal.
+ *
+ * Whitespaces, comments and string contents never appear in the result, so
+ * that the next stage does not have to look at them.
+ *
+ * Each 64-byte block is first classified into bit masks. Strings and
+ * comments are then resolved by walking only over the bits which can change
+ * the state: quotes and '/' outside of them, the matching quote and '\' in
+ * strings, line breaks in line comments, and '*' in block comments. Unlike
+ * JSON, JSON5 has two kinds of quotes and comments, and each of them hides
+ * the others, so the prefix-XOR trick used by JSON indexers does not apply.
+ */
+class structural_indexer
+{
+public:
+    explicit structural_indexer(std::string_view source)
+        : _source(source)
+        , _lexer(source)
+    {
+    }
+
+
+
+    std::vector<uint32_t> index()
+    {
+        std::vector<uint32_t> positions;
+        // Most tokens are a few bytes long.
+        positions.reserve(_source.size() / 4);
+        size_t base = 0;
+        for (; base + 64 <= _source.size(); base += 64)
+        {
+            process_block(_source.data() + base, base, positions);
+        }
+        if (base < _source.size())
+        {
+            // Padded with spaces, which are ignored.
+            char buf[64];
+            std::memset(buf, ' ', sizeof(buf));
+            std::memcpy(buf, _source.data() + base, _source.size() - base);
+            process_block(buf, base, positions);
+        }
+
+        switch (_state)
+        {
+        case state::double_quoted:
+            _lexer.seek(_source.size());
+            JSON5_THROW(_lexer.invalid_char("'\"'"));
+        case state::single_quoted:
+            _lexer.seek(_source.size());
+            JSON5_THROW(_lexer.invalid_char("'"));
+        case state::block_comment:
+            _lexer.seek(_source.size());
+            JSON5_THROW(_lexer.invalid_char("'*/'"));
+        default: break;
+        }
+        return positions;
+    }
+
+
+
+private:
+    enum class state
+    {
+        normal,
+        double_quoted,
+        single_quoted,
+        line_comment,
+        block_comment,
+    };
+
+    struct block_masks
+    {
+        uint64_t double_quote = 0;
+        uint64_t single_quote = 0;
+        uint64_t backslash = 0;
+        uint64_t slash = 0;
+        uint64_t star = 0;
+        uint64_t line_break = 0;
+        uint64_t structural = 0;
+        uint64_t whitespace = 0;
+    };
+
+    std::string_view _source;
+    // Only used to format error messages.
+    lexer _lexer;
+    state _state = state::normal;
+    // Where the current string or comment started.
+    size_t _region_start = 0;
+    // Bytes before this position have already been resolved.
+    size_t _resume = 0;
+    // Whether the last byte of the previous block belongs to a number or a
+    // literal.
+    uint64_t _prev_other = 0;
+
+
+
+    static block_masks classify(const char* p) noexcept
+    {
+        block_masks m;
+        for (size_t i = 0; i < 64; i += byte_block::size)
+        {
+            const auto b = byte_block::load(p + i);
+            m.double_quote |= uint64_t{b.eq('"')} << i;
+            m.single_quote |= uint64_t{b.eq('\'')} << i;
+            m.backslash |= uint64_t{b.eq('\\')} << i;
+            m.slash |= uint64_t{b.eq('/')} << i;
+            m.star |= uint64_t{b.eq('*')} << i;
+            const auto line_break = b.eq('\r') | b.eq('\n');
+            m.line_break |= uint64_t{line_break} << i;
+            m.structural |= uint64_t{b.eq('{') | b.eq('}') | b.eq('[') |
+                                     b.eq(']') | b.eq(':') | b.eq(',')}
+                << i;
+            m.whitespace |= uint64_t{line_break | b.eq(' ') | b.eq('\t')}
+                << i;
+        }
+        return m;
+    }
+
+
+
+    // Bits first to last, inclusive.
+    static uint64_t bit_range(size_t first, size_t last) noexcept
+    {
+        const uint64_t upto_last =
+            last == 63 ? ~uint64_t{0} : (uint64_t{1} << (last + 1)) - 1;
+        return upto_last & ~((uint64_t{1} << first) - 1);
+    }
+
+
+
+    static uint64_t prefix_xor(uint64_t x) noexcept
+    {
+        x ^= x << 1;
+        x ^= x << 2;
+        x ^= x << 4;
+        x ^= x << 8;
+        x ^= x << 16;
+        x ^= x << 32;
+        return x;
+    }
+
+
+
+    // Bits of the characters which follow an odd number of consecutive
+    // backslashes. Sets carry if the block ends with such a run.
+    static uint64_t escaped_chars(uint64_t backslash, bool& carry) noexcept
+    {
+        constexpr uint64_t even_bits = 0x5555'5555'5555'5555ull;
+        constexpr uint64_t odd_bits = ~even_bits;
+        const uint64_t starts = backslash & ~(backslash << 1);
+        // Adding the first bit of a run to it carries just past its end.
+        const uint64_t even_carries = backslash + (starts & even_bits);
+        const uint64_t odd_carries = backslash + (starts & odd_bits);
+        carry = odd_carries < backslash;
+        // A run has odd length if it starts and ends on bits of the same
+        // parity, so the bit after it has the other parity.
+        return (even_carries & ~backslash & odd_bits) |
+            (odd_carries & ~backslash & even_bits);
+    }
+
+
+
+    /*
+     * Most blocks contain no comment and only one kind of quote. Then every
+     * unescaped quote opens or closes a string, and the bytes inside strings
+     * are found without walking over the quotes.
+     */
+    bool resolve_quotes_only(
+        const block_masks& m,
+        size_t base,
+        uint64_t& region,
+        uint64_t& quotes)
+    {
+        if (base < _resume || m.slash || _state == state::line_comment ||
+            _state == state::block_comment)
+        {
+            return false;
+        }
+
+        bool double_quoted;
+        if (!m.single_quote && _state != state::single_quoted)
+        {
+            double_quoted = true;
+        }
+        else if (!m.double_quote && _state != state::double_quoted)
+        {
+            double_quoted = false;
+        }
+        else
+        {
+            return false;
+        }
+
+        quotes = double_quoted ? m.double_quote : m.single_quote;
+        if (m.backslash)
+        {
+            // Backslashes outside strings are rejected by the next stage.
+            bool carry;
+            quotes &= ~escaped_chars(m.backslash, carry);
+            if (carry)
+            {
+                // Let resolve() skip the escaped character.
+                _resume = base + 65;
+            }
+        }
+        // Set from each opening quote up to the byte before its closing one.
+        const uint64_t inside = prefix_xor(quotes) ^
+            (_state == state::normal ? uint64_t{0} : ~uint64_t{0});
+        region = inside | quotes;
+        if (inside >> 63)
+        {
+            _state =
+                double_quoted ? state::double_quoted : state::single_quoted;
+        }
+        else
+        {
+            _state = state::normal;
+        }
+        return true;
+    }
+
+
+
+    void resolve(
+        const block_masks& m,
+        const char* p,
+        size_t base,
+        uint64_t& region,
+        uint64_t& quotes)
+    {
+        if (base < _resume)
+        {
+            // The tail of a comment terminator or an escape sequence.
+            region |= bit_range(0, std::min<size_t>(_resume - base, 64) - 1);
+        }
+        if (_state != state::normal)
+        {
+            _region_start = base;
+        }
+
+        while (true)
+        {
+            uint64_t candidates;
+            switch (_state)
+            {
+            case state::normal:
+                candidates = m.double_quote | m.single_quote | m.slash;
+                break;
+            case state::double_quoted:
+                candidates = m.double_quote | m.backslash;
+                break;
+            case state::single_quoted:
+                candidates = m.single_quote | m.backslash;
+                break;
+            case state::line_comment: candidates = m.line_break; break;
+            default: candidates = m.star; break;
+            }
+            if (base < _resume)
+            {
+                candidates &= _resume - base < 64
+                    ? ~((uint64_t{1} << (_resume - base)) - 1)
+                    : 0;
+            }
+            if (!candidates)
+                break;
+
+            const auto i = count_trailing_zeros(candidates);
+            const auto pos = base + i;
+            const auto c = p[i];
+            _resume = pos + 1;
+            switch (_state)
+            {
+            case state::normal:
+                _region_start = pos;
+                if (c == '/')
+                {
+                    const auto next =
+                        pos + 1 < _source.size() ? _source[pos + 1] : '\0';
+                    if (next != '/' && next != '*')
+                    {
+                        _lexer.seek(pos + 1);
+                        JSON5_THROW(_lexer.invalid_char("'//' or '/*'"));
+                    }
+                    _state = next == '/' ? state::line_comment
+                                         : state::block_comment;
+                    _resume = pos + 2;
+                }
+                else
+                {
+                    _state = c == '"' ? state::double_quoted
+                                      : state::single_quoted;
+                    quotes |= uint64_t{1} << i;
+                }
+                break;
+            case state::double_quoted:
+            case state::single_quoted:
+                if (c == '\\')
+                {
+                    // The escaped character cannot close the string.
+                    _resume = pos + 2;
+                    break;
+                }
+                quotes |= uint64_t{1} << i;
+                region |= bit_range(_region_start - base, i);
+                _state = state::normal;
+                break;
+            case state::line_comment:
+                // The line break itself is a whitespace.
+                if (_region_start < pos)
+                {
+                    region |= bit_range(_region_start - base, i - 1);
+                }
+                _state = state::normal;
+                break;
+            default:
+                if (pos + 1 < _source.size() && _source[pos + 1] == '/')
+                {
+                    if (i < 63)
+                    {
+                        region |= bit_range(_region_start - base, i + 1);
+                    }
+                    else
+                    {
+                        // The '/' is masked at the start of the next block.
+                        region |= bit_range(_region_start - base, i);
+                    }
+                    _resume = pos + 2;
+                    _state = state::normal;
+                }
+                break;
+            }
+        }
+        if (_state != state::normal)
+        {
+            region |= bit_range(_region_start - base, 63);
+        }
+    }
+
+
+
+    void process_block(
+        const char* p,
+        size_t base,
+        std::vector<uint32_t>& positions)
+    {
+        const auto m = classify(p);
+
+        // Bits of the bytes in strings and comments, including delimiters.
+        uint64_t region = 0;
+        // Bits of the quotes which open or close strings.
+        uint64_t quotes = 0;
+        if (!resolve_quotes_only(m, base, region, quotes))
+        {
+            resolve(m, p, base, region, quotes);
+        }
+
+        const uint64_t structural = m.structural & ~region;
+        // Bytes of numbers and literals. Each run of them is one token.
+        const uint64_t other = ~(m.whitespace | m.structural | region);
+        const uint64_t starts = other & ~((other << 1) | _prev_other);
+        _prev_other = other >> 63;
+
+        for (auto bits = structural | quotes | starts; bits; bits &= bits - 1)
+        {
+            positions.push_back(
+                static_cast<uint32_t>(base + count_trailing_zeros(bits)));
+        }
+    }
+};
+
+} // namespace detail
+} // namespace json5
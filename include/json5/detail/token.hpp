@@ -2,6 +2,7 @@
 
 #include <cassert>
 #include <cmath>
+#include <string_view>
 #include "../types.hpp"
 #include "./util.hpp"
 
@@ -72,99 +73,17 @@ public:
 
 
 
-    token(token_type type, const string_type& value)
+    // The string is a view either into the source or into the lexer's
+    // scratch buffer, so it is only valid until the next token is scanned.
+    token(token_type type, std::string_view value)
         : _type(type)
-        , _as(new string_type(value))
-    {
-        assert(type == token_type::string || type == token_type::identifier);
-    }
-
-
-
-    token(token_type type, string_type&& value)
-        : _type(type)
-        , _as(new string_type(std::move(value)))
-    {
-        assert(type == token_type::string || type == token_type::identifier);
-    }
-
-
-
-    token(token_type type, const string_type::value_type* value)
-        : _type(type)
-        , _as(new string_type(value))
+        , _as(value)
     {
         assert(type == token_type::string || type == token_type::identifier);
     }
 
 
 
-    token(const token& other)
-        : _type(other._type)
-        , _as(other._as)
-    {
-        switch (_type)
-        {
-        case token_type::string:
-        case token_type::identifier:
-            _as.string = new string_type(*other._as.string);
-            break;
-        default: break;
-        }
-    }
-
-
-
-    token(token&& other) noexcept
-        : _type(other._type)
-        , _as(other._as)
-    {
-        switch (_type)
-        {
-        case token_type::string:
-        case token_type::identifier: other._as.string = nullptr; break;
-        default: break;
-        }
-    }
-
-
-
-    token& operator=(const token& other)
-    {
-        token tmp = other;
-        tmp.swap(*this);
-        return *this;
-    }
-
-
-
-    token& operator=(token&& other) noexcept
-    {
-        token tmp = std::move(other);
-        tmp.swap(*this);
-        return *this;
-    }
-
-
-
-    void swap(token& other)
-    {
-        std::swap(_type, other._type);
-        std::swap(_as, other._as);
-    }
-
-
-
-    ~token()
-    {
-        if (_type == token_type::string || _type == token_type::identifier)
-        {
-            delete _as.string;
-        }
-    }
-
-
-
     constexpr token_type type() const noexcept
     {
         return _type;
@@ -186,9 +105,9 @@ public:
 
 
 
-    constexpr const string_type& get_string() const noexcept
+    constexpr std::string_view get_string() const noexcept
     {
-        return *_as.string;
+        return _as.string;
     }
 
 
@@ -227,7 +146,7 @@ public:
             }
         }
         case token_type::string:
-        case token_type::identifier: return get_string();
+        case token_type::identifier: return std::string{get_string()};
         default: return "<invalid>";
         }
     }
@@ -242,7 +161,7 @@ private:
     {
         integer_type integer;
         number_type number;
-        string_type* string;
+        std::string_view string;
 
 
 
@@ -258,7 +177,7 @@ private:
         }
 
 
-        constexpr _U(string_type* v)
+        constexpr _U(std::string_view v)
             : string(v)
         {
         }
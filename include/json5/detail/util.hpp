@@ -122,36 +122,43 @@ inline char32_t surrogate_pair_to_codepoint(char16_t first, char16_t second)
 
 
 
-inline std::string codepoint_to_string(char32_t codepoint)
+inline bool is_surrogate_pair_second(uint32_t c)
+{
+    return 0xDC00 <= c && c <= 0xDFFF;
+}
+
+
+
+// String is std::string, or anything else with += for chars.
+template <typename String>
+void append_codepoint_as_utf8(String& s, char32_t codepoint)
 {
     if (codepoint <= U'\u007F')
     {
         // 1 byte in UTF-8
-        return std::string{1, static_cast<char>(codepoint)};
+        s += static_cast<char>(codepoint);
     }
     else if (codepoint <= U'\u07FF')
     {
         // 2 byte in UTF-8
-        const char first = 0b1100'0000 | (codepoint >> 6);
-        const char second = 0b1000'0000 | (codepoint & 0b0011'1111);
-        return std::string{first, second};
+        s += static_cast<char>(0b1100'0000 | (codepoint >> 6));
+        s += static_cast<char>(0b1000'0000 | (codepoint & 0b0011'1111));
     }
     else if (codepoint <= U'\uFFFF')
     {
         // 3 byte in UTF-8.
-        const char first = 0b1110'0000 | (codepoint >> 12);
-        const char second = 0b1000'0000 | ((codepoint >> 6) & 0b0011'1111);
-        const char third = 0b1000'0000 | (codepoint & 0b0011'1111);
-        return std::string{first, second, third};
+        s += static_cast<char>(0b1110'0000 | (codepoint >> 12));
+        s += static_cast<char>(0b1000'0000 | ((codepoint >> 6) & 0b0011'1111));
+        s += static_cast<char>(0b1000'0000 | (codepoint & 0b0011'1111));
     }
     else
     {
         // 4 byte in UTF-8.
-        const char first = 0b1111'0000 | (codepoint >> 18);
-        const char second = 0b1000'0000 | ((codepoint >> 12) & 0b0011'1111);
-        const char third = 0b1000'0000 | ((codepoint >> 6) & 0b0011'1111);
-        const char forth = 0b1000'0000 | (codepoint & 0b0011'1111);
-        return std::string{first, second, third, forth};
+        s += static_cast<char>(0b1111'0000 | (codepoint >> 18));
+        s += static_cast<char>(
+            0b1000'0000 | ((codepoint >> 12) & 0b0011'1111));
+        s += static_cast<char>(0b1000'0000 | ((codepoint >> 6) & 0b0011'1111));
+        s += static_cast<char>(0b1000'0000 | (codepoint & 0b0011'1111));
     }
 }
 
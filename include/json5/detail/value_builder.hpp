@@ -0,0 +1,141 @@
+#pragma once
+
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "../value.hpp"
+#include "./object_builder.hpp"
+
+
+
+namespace json5
+{
+namespace detail
+{
+
+/*
+ * Parser handler which builds a value. Containers being parsed are kept on an
+ * explicit stack, and each finished value is moved into its parent once.
+ */
+class value_builder
+{
+public:
+    void on_null()
+    {
+        add(value{});
+    }
+
+
+
+    void on_boolean(boolean_type v)
+    {
+        add(value{v});
+    }
+
+
+
+    void on_integer(integer_type v)
+    {
+        add(value{v});
+    }
+
+
+
+    void on_number(number_type v)
+    {
+        add(value{v});
+    }
+
+
+
+    void on_string(std::string_view v)
+    {
+        add(value{string_type{v}});
+    }
+
+
+
+    void on_key(std::string_view k)
+    {
+        _stack.back().key.assign(k.data(), k.size());
+    }
+
+
+
+    void on_start_array()
+    {
+        _stack.emplace_back();
+    }
+
+
+
+    void on_end_array()
+    {
+        auto array = value{std::move(_stack.back().array)};
+        _stack.pop_back();
+        add(std::move(array));
+    }
+
+
+
+    void on_start_object()
+    {
+        _stack.emplace_back();
+        _stack.back().is_object = true;
+    }
+
+
+
+    void on_end_object()
+    {
+        auto object = value{_stack.back().object.finish()};
+        _stack.pop_back();
+        add(std::move(object));
+    }
+
+
+
+    value finish()
+    {
+        return std::move(_root);
+    }
+
+
+
+private:
+    struct frame
+    {
+        bool is_object = false;
+        value::array_type array;
+        object_builder<value::object_type> object;
+        // The key of the member whose value is being parsed.
+        string_type key;
+    };
+
+    std::vector<frame> _stack;
+    value _root;
+
+
+
+    void add(value&& v)
+    {
+        if (_stack.empty())
+        {
+            _root = std::move(v);
+            return;
+        }
+
+        auto& parent = _stack.back();
+        if (parent.is_object)
+        {
+            parent.object.add(std::move(parent.key), std::move(v));
+        }
+        else
+        {
+            parent.array.push_back(std::move(v));
+        }
+    }
+};
+
+} // namespace detail
+} // namespace json5
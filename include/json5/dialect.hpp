@@ -0,0 +1,74 @@
+#pragma once
+
+
+
+namespace json5
+{
+
+/*
+ * A dialect selects the syntax the parser accepts. Each feature is a
+ * compile-time constant, so the checks for features a dialect lacks are
+ * left out of the parser instantiated for it:
+ *
+ *     const auto v = json5::parse<json5::json_dialect>(source);
+ *
+ * Other dialects can be made by deriving from one of these and redeclaring
+ * some of the members. In all of them, whitespace is limited to that of
+ * JSON, and identifiers to ASCII letters, digits, '$' and '_'.
+ */
+
+// JSON, as specified by RFC 8259.
+struct json_dialect
+{
+    // "//" and "/* */" comments.
+    static constexpr bool comments = false;
+    // Strings in single quotes.
+    static constexpr bool single_quotes = false;
+    // Object keys written as identifiers, such as {key: 1}.
+    static constexpr bool identifier_keys = false;
+    // Infinity and NaN, with an optional sign.
+    static constexpr bool infinity_and_nan = false;
+    // Hexadecimal integers, such as 0x1F.
+    static constexpr bool hexadecimal = false;
+    // Numbers with a leading '+'.
+    static constexpr bool leading_plus = false;
+    // Decimal points with no digit before or after them, such as .5 and 5.
+    static constexpr bool bare_decimal_point = false;
+    // Decimal numbers starting with 0 followed by a digit, such as 007.
+    static constexpr bool leading_zeros = false;
+    // Escape sequences beyond those of JSON: \', \v, \0, \xNN, escaped line
+    // breaks, and any other escaped character standing for itself.
+    static constexpr bool json5_escapes = false;
+    // Raw control characters in strings, except line breaks.
+    static constexpr bool control_characters = false;
+    // A comma after the last element of an array or member of an object.
+    static constexpr bool trailing_commas = false;
+};
+
+
+
+// JSON5, as specified by https://spec.json5.org/.
+struct json5_dialect
+{
+    static constexpr bool comments = true;
+    static constexpr bool single_quotes = true;
+    static constexpr bool identifier_keys = true;
+    static constexpr bool infinity_and_nan = true;
+    static constexpr bool hexadecimal = true;
+    static constexpr bool leading_plus = true;
+    static constexpr bool bare_decimal_point = true;
+    static constexpr bool leading_zeros = false;
+    static constexpr bool json5_escapes = true;
+    static constexpr bool control_characters = true;
+    static constexpr bool trailing_commas = true;
+};
+
+
+
+// JSON5 plus leading zeros. It is the dialect parsed by default.
+struct json5_extended_dialect : json5_dialect
+{
+    static constexpr bool leading_zeros = true;
+};
+
+} // namespace json5
@@ -0,0 +1,626 @@
+#pragma once
+
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include "./detail/arena.hpp"
+#include "./detail/object_builder.hpp"
+#include "./detail/preprocessor.hpp"
+#include "./intern_table.hpp"
+#include "./value.hpp"
+
+
+
+namespace json5
+{
+
+struct document_options
+{
+    // Stores each distinct object key once, so that keys can be compared by
+    // pointer. See document_object::find_interned().
+    bool intern_keys = false;
+    // String values up to this many bytes are interned as well.
+    size_t intern_string_values_up_to = 0;
+    // Interns into this table instead of one owned by the document. It must
+    // outlive the document, and be thread-safe if parses run concurrently.
+    intern_table* shared_table = nullptr;
+
+
+
+    bool interns() const noexcept
+    {
+        return intern_keys || intern_string_values_up_to != 0;
+    }
+};
+
+
+
+namespace detail
+{
+
+struct document_member;
+
+
+
+// A node of a document. Nodes, member arrays and string contents all live in
+// the document's arena, and none of them has a non-trivial destructor.
+struct document_node
+{
+    value_type type;
+    // Byte length of a string, or the number of elements or members.
+    uint32_t size;
+
+    union
+    {
+        boolean_type boolean;
+        integer_type integer;
+        number_type number;
+        const char* string;
+        const document_node* elements;
+        const document_member* members;
+    } as;
+};
+
+
+
+struct document_member
+{
+    const char* key;
+    uint32_t key_size;
+    document_node value;
+};
+
+} // namespace detail
+
+
+
+class document_array;
+class document_object;
+
+
+
+/*
+ * Read-only view of a node in a document. It is valid as long as the
+ * document it comes from is alive.
+ */
+class document_value
+{
+public:
+    explicit document_value(const detail::document_node* node) noexcept
+        : _node(node)
+    {
+    }
+
+
+
+    value_type type() const noexcept
+    {
+        return _node->type;
+    }
+
+
+
+    bool is_null() const noexcept
+    {
+        return type() == value_type::null;
+    }
+
+
+
+    bool is_boolean() const noexcept
+    {
+        return type() == value_type::boolean;
+    }
+
+
+
+    bool is_integer() const noexcept
+    {
+        return type() == value_type::integer;
+    }
+
+
+
+    bool is_number() const noexcept
+    {
+        return type() == value_type::number;
+    }
+
+
+
+    bool is_string() const noexcept
+    {
+        return type() == value_type::string;
+    }
+
+
+
+    bool is_array() const noexcept
+    {
+        return type() == value_type::array;
+    }
+
+
+
+    bool is_object() const noexcept
+    {
+        return type() == value_type::object;
+    }
+
+
+
+    boolean_type get_boolean() const
+    {
+        expect(value_type::boolean);
+        return _node->as.boolean;
+    }
+
+
+
+    integer_type get_integer() const
+    {
+        expect(value_type::integer);
+        return _node->as.integer;
+    }
+
+
+
+    number_type get_number() const
+    {
+        expect(value_type::number);
+        return _node->as.number;
+    }
+
+
+
+    std::string_view get_string() const
+    {
+        expect(value_type::string);
+        return {_node->as.string, _node->size};
+    }
+
+
+
+    inline document_array get_array() const;
+    inline document_object get_object() const;
+
+
+
+    // Deep-copies the node into a heap-allocated value.
+    inline value to_value() const;
+
+
+
+private:
+    const detail::document_node* _node;
+
+
+
+    void expect(value_type expected_type) const
+    {
+        if (type() != expected_type)
+        {
+            JSON5_THROW(invalid_type_error{type(), expected_type});
+        }
+    }
+};
+
+
+
+class document_array
+{
+public:
+    class iterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = document_value;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = document_value;
+
+
+
+        explicit iterator(const detail::document_node* p) noexcept
+            : _p(p)
+        {
+        }
+
+
+
+        document_value operator*() const noexcept
+        {
+            return document_value{_p};
+        }
+
+
+
+        iterator& operator++() noexcept
+        {
+            ++_p;
+            return *this;
+        }
+
+
+
+        iterator operator++(int) noexcept
+        {
+            return iterator{_p++};
+        }
+
+
+
+        difference_type operator-(const iterator& other) const noexcept
+        {
+            return _p - other._p;
+        }
+
+
+
+        bool operator==(const iterator& other) const noexcept
+        {
+            return _p == other._p;
+        }
+
+
+
+        bool operator!=(const iterator& other) const noexcept
+        {
+            return _p != other._p;
+        }
+
+
+
+    private:
+        const detail::document_node* _p;
+    };
+
+
+
+    explicit document_array(const detail::document_node* node) noexcept
+        : _node(node)
+    {
+    }
+
+
+
+    size_t size() const noexcept
+    {
+        return _node->size;
+    }
+
+
+
+    bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+
+
+    document_value operator[](size_t index) const noexcept
+    {
+        return document_value{_node->as.elements + index};
+    }
+
+
+
+    document_value at(size_t index) const
+    {
+        if (size() <= index)
+        {
+            JSON5_THROW(std::out_of_range{"document_array::at"});
+        }
+        return (*this)[index];
+    }
+
+
+
+    iterator begin() const noexcept
+    {
+        return iterator{_node->as.elements};
+    }
+
+
+
+    iterator end() const noexcept
+    {
+        return iterator{_node->as.elements + size()};
+    }
+
+
+
+private:
+    const detail::document_node* _node;
+};
+
+
+
+/*
+ * Members are kept in source order. Lookup is a linear scan which returns
+ * the first member with the key, the same member std::map-based value keeps
+ * for duplicated keys.
+ */
+class document_object
+{
+public:
+    class iterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::pair<std::string_view, document_value>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = value_type;
+
+
+
+        explicit iterator(const detail::document_member* p) noexcept
+            : _p(p)
+        {
+        }
+
+
+
+        value_type operator*() const noexcept
+        {
+            return {
+                std::string_view{_p->key, _p->key_size},
+                document_value{&_p->value}};
+        }
+
+
+
+        iterator& operator++() noexcept
+        {
+            ++_p;
+            return *this;
+        }
+
+
+
+        iterator operator++(int) noexcept
+        {
+            return iterator{_p++};
+        }
+
+
+
+        difference_type operator-(const iterator& other) const noexcept
+        {
+            return _p - other._p;
+        }
+
+
+
+        bool operator==(const iterator& other) const noexcept
+        {
+            return _p == other._p;
+        }
+
+
+
+        bool operator!=(const iterator& other) const noexcept
+        {
+            return _p != other._p;
+        }
+
+
+
+    private:
+        const detail::document_member* _p;
+    };
+
+
+
+    explicit document_object(const detail::document_node* node) noexcept
+        : _node(node)
+    {
+    }
+
+
+
+    size_t size() const noexcept
+    {
+        return _node->size;
+    }
+
+
+
+    bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+
+
+    iterator begin() const noexcept
+    {
+        return iterator{_node->as.members};
+    }
+
+
+
+    iterator end() const noexcept
+    {
+        return iterator{_node->as.members + size()};
+    }
+
+
+
+    iterator find(std::string_view key) const noexcept
+    {
+        const auto first = _node->as.members;
+        const auto last = first + size();
+        for (auto p = first; p != last; ++p)
+        {
+            if (p->key_size == key.size() &&
+                (p->key == key.data() ||
+                 std::memcmp(p->key, key.data(), key.size()) == 0))
+            {
+                return iterator{p};
+            }
+        }
+        return end();
+    }
+
+
+
+    // Compares keys by pointer only. key must come from the intern table of
+    // a document parsed with intern_keys, e.g. via document::find_interned().
+    iterator find_interned(std::string_view key) const noexcept
+    {
+        const auto first = _node->as.members;
+        const auto last = first + size();
+        for (auto p = first; p != last; ++p)
+        {
+            if (p->key == key.data())
+            {
+                return iterator{p};
+            }
+        }
+        return end();
+    }
+
+
+
+    size_t count(std::string_view key) const noexcept
+    {
+        return find(key) == end() ? 0 : 1;
+    }
+
+
+
+    document_value at(std::string_view key) const
+    {
+        const auto itr = find(key);
+        if (itr == end())
+        {
+            JSON5_THROW(std::out_of_range{"document_object::at"});
+        }
+        return (*itr).second;
+    }
+
+
+
+private:
+    const detail::document_node* _node;
+};
+
+
+
+inline document_array document_value::get_array() const
+{
+    expect(value_type::array);
+    return document_array{_node};
+}
+
+
+
+inline document_object document_value::get_object() const
+{
+    expect(value_type::object);
+    return document_object{_node};
+}
+
+
+
+inline value document_value::to_value() const
+{
+    switch (type())
+    {
+    case value_type::null: return value{};
+    case value_type::boolean: return value{_node->as.boolean};
+    case value_type::integer: return value{_node->as.integer};
+    case value_type::number: return value{_node->as.number};
+    case value_type::string: return value{string_type{get_string()}};
+    case value_type::array:
+    {
+        value::array_type array;
+        array.reserve(_node->size);
+        for (const auto& v : get_array())
+        {
+            array.push_back(v.to_value());
+        }
+        return value{std::move(array)};
+    }
+    case value_type::object:
+    {
+        detail::object_builder<value::object_type> object;
+        for (const auto& kvp : get_object())
+        {
+            object.add(string_type{kvp.first}, kvp.second.to_value());
+        }
+        return value{object.finish()};
+    }
+    default: return value{}; // unreachable
+    }
+}
+
+
+
+/*
+ * A parsed JSON5 document whose nodes and strings are all allocated in one
+ * arena. Parsing is bump-pointer allocation, and destroying the document
+ * frees the arena blocks without visiting any node.
+ */
+class document
+{
+public:
+    document(
+        detail::arena&& arena,
+        std::unique_ptr<json5::intern_table> own_table,
+        const json5::intern_table* table,
+        const detail::document_node* root) noexcept
+        : _arena(std::move(arena))
+        , _own_table(std::move(own_table))
+        , _table(table)
+        , _root(root)
+    {
+    }
+
+
+
+    document_value root() const noexcept
+    {
+        return document_value{_root};
+    }
+
+
+
+    size_t arena_block_count() const noexcept
+    {
+        return _arena.block_count();
+    }
+
+
+
+    // The table strings were interned into, or nullptr if interning was not
+    // enabled.
+    const json5::intern_table* intern_table() const noexcept
+    {
+        return _table;
+    }
+
+
+
+    // Returns the interned copy of s to pass to document_object::
+    // find_interned(). Its data() is nullptr if no such string was interned.
+    std::string_view find_interned(std::string_view s) const
+    {
+        return _table ? _table->find(s) : std::string_view{};
+    }
+
+
+
+private:
+    detail::arena _arena;
+    std::unique_ptr<json5::intern_table> _own_table;
+    const json5::intern_table* _table;
+    const detail::document_node* _root;
+};
+
+} // namespace json5
@@ -0,0 +1,57 @@
+#pragma once
+
+
+
+namespace json5
+{
+
+// Why a source failed to parse. See try_parse().
+enum class error_code
+{
+    ok,
+    // The source ends in the middle of a value.
+    unexpected_end,
+    // A token which cannot appear where it is, such as a missing ','.
+    unexpected_token,
+    // A character which cannot start a token, or continue the one it is in.
+    invalid_character,
+    // A string with no closing quote.
+    unterminated_string,
+    // A block comment with no closing "*/".
+    unterminated_comment,
+    // A raw line break in a string, or, in strict dialects, a raw control
+    // character.
+    invalid_string_character,
+    // A malformed escape sequence, or a lone surrogate.
+    invalid_escape,
+    // A malformed number, or a sign before a literal other than a number.
+    invalid_number,
+    // A number which does not fit its type.
+    number_out_of_range,
+    // Arrays and objects nested deeper than JSON5_MAX_DEPTH.
+    too_deep,
+};
+
+
+
+constexpr const char* to_string(error_code code) noexcept
+{
+    switch (code)
+    {
+    case error_code::ok: return "ok";
+    case error_code::unexpected_end: return "unexpected end";
+    case error_code::unexpected_token: return "unexpected token";
+    case error_code::invalid_character: return "invalid character";
+    case error_code::unterminated_string: return "unterminated string";
+    case error_code::unterminated_comment: return "unterminated comment";
+    case error_code::invalid_string_character:
+        return "invalid character in string";
+    case error_code::invalid_escape: return "invalid escape sequence";
+    case error_code::invalid_number: return "invalid number";
+    case error_code::number_out_of_range: return "number out of range";
+    case error_code::too_deep: return "nested too deep";
+    default: return "<invalid>";
+    }
+}
+
+} // namespace json5
@@ -0,0 +1,338 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "./detail/object_builder.hpp"
+#include "./detail/preprocessor.hpp"
+
+
+
+namespace json5
+{
+
+/*
+ * Associative container backed by a vector of key-value pairs sorted by key.
+ * Members are contiguous, so iteration and lookups in small objects touch
+ * very few cache lines. Insertion into the middle is O(n); objects are built
+ * in bulk by the parser instead.
+ */
+template <typename K, typename V, typename Compare = std::less<>>
+class flat_map
+{
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<K, V>;
+    using size_type = size_t;
+    using key_compare = Compare;
+    using container_type = std::vector<value_type>;
+    using iterator = typename container_type::iterator;
+    using const_iterator = typename container_type::const_iterator;
+
+
+
+    flat_map() = default;
+
+
+
+    // items need not be sorted. Of duplicated keys, the first one is kept.
+    explicit flat_map(container_type items)
+        : _items(std::move(items))
+    {
+        const auto less = [this](const value_type& lhs, const value_type& rhs) {
+            return _compare(lhs.first, rhs.first);
+        };
+        if (_items.size() <= 16)
+        {
+            // Stable insertion sort; std::stable_sort allocates a buffer.
+            for (auto i = _items.begin(); i != _items.end(); ++i)
+            {
+                auto j = i;
+                while (j != _items.begin() && less(*i, *std::prev(j)))
+                {
+                    --j;
+                }
+                std::rotate(j, i, std::next(i));
+            }
+        }
+        else
+        {
+            std::stable_sort(_items.begin(), _items.end(), less);
+        }
+        _items.erase(
+            std::unique(
+                _items.begin(),
+                _items.end(),
+                [this](const value_type& lhs, const value_type& rhs) {
+                    return !_compare(lhs.first, rhs.first);
+                }),
+            _items.end());
+    }
+
+
+
+    iterator begin() noexcept
+    {
+        return _items.begin();
+    }
+
+
+
+    const_iterator begin() const noexcept
+    {
+        return _items.begin();
+    }
+
+
+
+    const_iterator cbegin() const noexcept
+    {
+        return _items.cbegin();
+    }
+
+
+
+    iterator end() noexcept
+    {
+        return _items.end();
+    }
+
+
+
+    const_iterator end() const noexcept
+    {
+        return _items.end();
+    }
+
+
+
+    const_iterator cend() const noexcept
+    {
+        return _items.cend();
+    }
+
+
+
+    size_type size() const noexcept
+    {
+        return _items.size();
+    }
+
+
+
+    bool empty() const noexcept
+    {
+        return _items.empty();
+    }
+
+
+
+    void clear() noexcept
+    {
+        _items.clear();
+    }
+
+
+
+    void reserve(size_type n)
+    {
+        _items.reserve(n);
+    }
+
+
+
+    template <typename Key>
+    iterator find(const Key& k)
+    {
+        const auto itr = lower_bound(k);
+        return itr != end() && !_compare(k, itr->first) ? itr : end();
+    }
+
+
+
+    template <typename Key>
+    const_iterator find(const Key& k) const
+    {
+        const auto itr = lower_bound(k);
+        return itr != end() && !_compare(k, itr->first) ? itr : end();
+    }
+
+
+
+    template <typename Key>
+    size_type count(const Key& k) const
+    {
+        return find(k) == end() ? 0 : 1;
+    }
+
+
+
+    template <typename Key>
+    bool contains(const Key& k) const
+    {
+        return find(k) != end();
+    }
+
+
+
+    template <typename Key>
+    V& at(const Key& k)
+    {
+        const auto itr = find(k);
+        if (itr == end())
+        {
+            JSON5_THROW(std::out_of_range{"flat_map::at"});
+        }
+        return itr->second;
+    }
+
+
+
+    template <typename Key>
+    const V& at(const Key& k) const
+    {
+        const auto itr = find(k);
+        if (itr == end())
+        {
+            JSON5_THROW(std::out_of_range{"flat_map::at"});
+        }
+        return itr->second;
+    }
+
+
+
+    V& operator[](const K& k)
+    {
+        return emplace(k, V{}).first->second;
+    }
+
+
+
+    template <typename Key, typename... Args>
+    std::pair<iterator, bool> emplace(Key&& k, Args&&... args)
+    {
+        // Appending keys in ascending order is the common case.
+        if (_items.empty() || _compare(_items.back().first, k))
+        {
+            _items.emplace_back(
+                std::piecewise_construct,
+                std::forward_as_tuple(std::forward<Key>(k)),
+                std::forward_as_tuple(std::forward<Args>(args)...));
+            return {std::prev(_items.end()), true};
+        }
+
+        const auto itr = lower_bound(k);
+        if (itr != end() && !_compare(k, itr->first))
+        {
+            return {itr, false};
+        }
+        return {_items.emplace(
+                    itr,
+                    std::piecewise_construct,
+                    std::forward_as_tuple(std::forward<Key>(k)),
+                    std::forward_as_tuple(std::forward<Args>(args)...)),
+                true};
+    }
+
+
+
+    std::pair<iterator, bool> insert(const value_type& kvp)
+    {
+        return emplace(kvp.first, kvp.second);
+    }
+
+
+
+    std::pair<iterator, bool> insert(value_type&& kvp)
+    {
+        return emplace(std::move(kvp.first), std::move(kvp.second));
+    }
+
+
+
+    iterator erase(const_iterator pos)
+    {
+        return _items.erase(pos);
+    }
+
+
+
+    template <typename Key>
+    size_type erase(const Key& k)
+    {
+        const auto itr = find(k);
+        if (itr == end())
+            return 0;
+        _items.erase(itr);
+        return 1;
+    }
+
+
+
+private:
+    container_type _items;
+    Compare _compare;
+
+
+
+    template <typename Key>
+    iterator lower_bound(const Key& k)
+    {
+        return std::lower_bound(
+            _items.begin(),
+            _items.end(),
+            k,
+            [this](const value_type& item, const Key& key) {
+                return _compare(item.first, key);
+            });
+    }
+
+
+
+    template <typename Key>
+    const_iterator lower_bound(const Key& k) const
+    {
+        return std::lower_bound(
+            _items.begin(),
+            _items.end(),
+            k,
+            [this](const value_type& item, const Key& key) {
+                return _compare(item.first, key);
+            });
+    }
+};
+
+
+
+namespace detail
+{
+
+template <typename K, typename V, typename Compare>
+struct object_builder<flat_map<K, V, Compare>>
+{
+    typename flat_map<K, V, Compare>::container_type items;
+
+
+
+    template <typename K_, typename V_>
+    void add(K_&& k, V_&& v)
+    {
+        items.emplace_back(std::forward<K_>(k), std::forward<V_>(v));
+    }
+
+
+
+    flat_map<K, V, Compare> finish()
+    {
+        // Sorted once here rather than on every insertion.
+        return flat_map<K, V, Compare>{std::move(items)};
+    }
+};
+
+} // namespace detail
+
+} // namespace json5
@@ -0,0 +1,300 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "./detail/preprocessor.hpp"
+
+
+
+namespace json5
+{
+
+/*
+ * Associative container with open addressing. Key-value pairs are stored
+ * densely in insertion order, and a power-of-two table of 32-bit indices into
+ * them is probed linearly. Iteration therefore follows the source order of
+ * the object. Erasure is O(n) because it keeps that order.
+ */
+template <
+    typename K,
+    typename V,
+    typename Hash = std::hash<K>,
+    typename KeyEqual = std::equal_to<>>
+class hash_map
+{
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<K, V>;
+    using size_type = size_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using container_type = std::vector<value_type>;
+    using iterator = typename container_type::iterator;
+    using const_iterator = typename container_type::const_iterator;
+
+
+
+    iterator begin() noexcept
+    {
+        return _items.begin();
+    }
+
+
+
+    const_iterator begin() const noexcept
+    {
+        return _items.begin();
+    }
+
+
+
+    const_iterator cbegin() const noexcept
+    {
+        return _items.cbegin();
+    }
+
+
+
+    iterator end() noexcept
+    {
+        return _items.end();
+    }
+
+
+
+    const_iterator end() const noexcept
+    {
+        return _items.end();
+    }
+
+
+
+    const_iterator cend() const noexcept
+    {
+        return _items.cend();
+    }
+
+
+
+    size_type size() const noexcept
+    {
+        return _items.size();
+    }
+
+
+
+    bool empty() const noexcept
+    {
+        return _items.empty();
+    }
+
+
+
+    void clear() noexcept
+    {
+        _items.clear();
+        _slots.clear();
+    }
+
+
+
+    void reserve(size_type n)
+    {
+        _items.reserve(n);
+        if (_slots.size() < table_size_for(n))
+        {
+            rehash(table_size_for(n));
+        }
+    }
+
+
+
+    iterator find(const K& k)
+    {
+        const auto i = find_index(k);
+        return i == empty_slot ? end() : begin() + i;
+    }
+
+
+
+    const_iterator find(const K& k) const
+    {
+        const auto i = find_index(k);
+        return i == empty_slot ? end() : begin() + i;
+    }
+
+
+
+    size_type count(const K& k) const
+    {
+        return find_index(k) == empty_slot ? 0 : 1;
+    }
+
+
+
+    bool contains(const K& k) const
+    {
+        return find_index(k) != empty_slot;
+    }
+
+
+
+    V& at(const K& k)
+    {
+        const auto itr = find(k);
+        if (itr == end())
+        {
+            JSON5_THROW(std::out_of_range{"hash_map::at"});
+        }
+        return itr->second;
+    }
+
+
+
+    const V& at(const K& k) const
+    {
+        const auto itr = find(k);
+        if (itr == end())
+        {
+            JSON5_THROW(std::out_of_range{"hash_map::at"});
+        }
+        return itr->second;
+    }
+
+
+
+    V& operator[](const K& k)
+    {
+        return emplace(k, V{}).first->second;
+    }
+
+
+
+    template <typename Key, typename... Args>
+    std::pair<iterator, bool> emplace(Key&& k, Args&&... args)
+    {
+        if (_slots.size() < table_size_for(_items.size() + 1))
+        {
+            rehash(table_size_for(_items.size() + 1));
+        }
+
+        const auto mask = _slots.size() - 1;
+        for (size_t s = _hash(k) & mask;; s = (s + 1) & mask)
+        {
+            const auto i = _slots[s];
+            if (i == empty_slot)
+            {
+                _slots[s] = static_cast<uint32_t>(_items.size());
+                _items.emplace_back(
+                    std::piecewise_construct,
+                    std::forward_as_tuple(std::forward<Key>(k)),
+                    std::forward_as_tuple(std::forward<Args>(args)...));
+                return {std::prev(_items.end()), true};
+            }
+            if (_equal(_items[i].first, k))
+            {
+                return {begin() + i, false};
+            }
+        }
+    }
+
+
+
+    std::pair<iterator, bool> insert(const value_type& kvp)
+    {
+        return emplace(kvp.first, kvp.second);
+    }
+
+
+
+    std::pair<iterator, bool> insert(value_type&& kvp)
+    {
+        return emplace(std::move(kvp.first), std::move(kvp.second));
+    }
+
+
+
+    iterator erase(const_iterator pos)
+    {
+        const auto offset = pos - cbegin();
+        _items.erase(pos);
+        rehash(_slots.size());
+        return begin() + offset;
+    }
+
+
+
+    size_type erase(const K& k)
+    {
+        const auto itr = find(k);
+        if (itr == end())
+            return 0;
+        erase(itr);
+        return 1;
+    }
+
+
+
+private:
+    static constexpr uint32_t empty_slot = 0xFFFF'FFFF;
+
+    container_type _items;
+    std::vector<uint32_t> _slots;
+    Hash _hash;
+    KeyEqual _equal;
+
+
+
+    // Keeps the load factor at most 1/2 so that probe sequences stay short.
+    static size_t table_size_for(size_t n) noexcept
+    {
+        size_t size = 8;
+        while (size < n * 2)
+        {
+            size *= 2;
+        }
+        return size;
+    }
+
+
+
+    uint32_t find_index(const K& k) const
+    {
+        if (_slots.empty())
+            return empty_slot;
+
+        const auto mask = _slots.size() - 1;
+        for (size_t s = _hash(k) & mask;; s = (s + 1) & mask)
+        {
+            const auto i = _slots[s];
+            if (i == empty_slot || _equal(_items[i].first, k))
+            {
+                return i;
+            }
+        }
+    }
+
+
+
+    void rehash(size_t table_size)
+    {
+        _slots.assign(table_size, empty_slot);
+        const auto mask = table_size - 1;
+        for (size_t i = 0; i < _items.size(); ++i)
+        {
+            auto s = _hash(_items[i].first) & mask;
+            while (_slots[s] != empty_slot)
+            {
+                s = (s + 1) & mask;
+            }
+            _slots[s] = static_cast<uint32_t>(i);
+        }
+    }
+};
+
+} // namespace json5
@@ -0,0 +1,315 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include "./detail/lexer.hpp"
+#include "./detail/preprocessor.hpp"
+#include "./detail/push_parser.hpp"
+#include "./detail/simd.hpp"
+#include "./detail/util.hpp"
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+
+
+namespace json5
+{
+
+/*
+ * Parser which is given the source in chunks of any size, reporting events to
+ * a handler like sax_parse(). Chunks may split the source anywhere, even in
+ * the middle of a token, an escape sequence or a comment.
+ *
+ *     json5::incremental_parser<MyHandler> p{handler};
+ *     while (...)
+ *     {
+ *         p.feed(buf, len);
+ *     }
+ *     p.finish();
+ *
+ * Chunks are not kept: only the bytes of an unfinished token are copied to
+ * an internal buffer, so the memory used does not depend on the size of the
+ * source. Comments are dropped as they are read.
+ */
+template <typename Handler>
+class incremental_parser
+{
+public:
+    explicit incremental_parser(Handler& handler)
+        : _parser(handler)
+    {
+    }
+
+
+
+    void feed(const char* data, size_t size)
+    {
+        if (_buffer.empty())
+        {
+            // Usually only a few bytes at the end are left over.
+            const std::string_view chunk{data, size};
+            _buffer.assign(chunk.substr(consume(chunk)));
+        }
+        else
+        {
+            _buffer.append(data, size);
+            _buffer.erase(0, consume(_buffer));
+        }
+    }
+
+
+
+    void feed(std::string_view chunk)
+    {
+        feed(chunk.data(), chunk.size());
+    }
+
+
+
+    // Reads the stream to its end and feeds it.
+    void feed(std::istream& in)
+    {
+        const auto chunk = std::make_unique<char[]>(chunk_size);
+        while (in)
+        {
+            in.read(chunk.get(), chunk_size);
+            feed(chunk.get(), static_cast<size_t>(in.gcount()));
+        }
+        if (in.bad())
+        {
+            JSON5_THROW(
+                std::ios_base::failure{"failed to read the input stream"});
+        }
+    }
+
+
+
+    // Reads the file descriptor, which may be a pipe, to its end and feeds
+    // it.
+    void feed_fd(int fd)
+    {
+        const auto chunk = std::make_unique<char[]>(chunk_size);
+        while (true)
+        {
+#if defined(_WIN32)
+            const auto n = ::_read(fd, chunk.get(), chunk_size);
+#else
+            const auto n = ::read(fd, chunk.get(), chunk_size);
+#endif
+            if (n == 0)
+                break;
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                JSON5_THROW(std::system_error{
+                    errno, std::generic_category(), "failed to read"});
+            }
+            feed(chunk.get(), static_cast<size_t>(n));
+        }
+    }
+
+
+
+    // Tells the parser that the source has ended, and checks that it was a
+    // complete JSON5 value.
+    void finish()
+    {
+        if (_comment == comment::block)
+        {
+            detail::lexer lx{std::string_view{}};
+            JSON5_THROW(lx.invalid_char("'*/'"));
+        }
+
+        detail::lexer lx{_buffer};
+        while (true)
+        {
+            const auto tok = lx.scan();
+            _parser.push(tok);
+            if (tok.type() == detail::token_type::eof)
+                break;
+        }
+        _buffer.clear();
+    }
+
+
+
+private:
+    enum class comment
+    {
+        none,
+        line,
+        block,
+    };
+
+    static constexpr size_t chunk_size = 64 * 1024;
+
+    detail::push_parser<Handler> _parser;
+    // Unconsumed bytes from the previous chunks.
+    std::string _buffer;
+    // The comment the last chunk ended in, if any.
+    comment _comment = comment::none;
+    // How many bytes of the unfinished token at the start of _buffer are
+    // known not to end it.
+    size_t _scanned = 0;
+
+
+
+    // Passes every complete token in s to the parser. Returns the number of
+    // bytes consumed.
+    size_t consume(std::string_view s)
+    {
+        detail::lexer lx{s};
+        size_t pos = 0;
+        while (true)
+        {
+            size_t start;
+            if (!skip_separators(s, pos, start) || !is_complete_token(s, start))
+                return start;
+
+            lx.seek(start);
+            _parser.push(lx.scan());
+            pos = lx.position();
+        }
+    }
+
+
+
+    /*
+     * Skips whitespaces and comments from pos, and sets start to the next
+     * token. Returns false if s ends first; then start is where the bytes
+     * still needed begin.
+     */
+    bool skip_separators(std::string_view s, size_t pos, size_t& start)
+    {
+        const auto first = s.data();
+        const auto last = first + s.size();
+        auto p = first + pos;
+        while (true)
+        {
+            if (_comment == comment::line)
+            {
+                p = detail::find_line_break(p, last);
+                if (p == last)
+                {
+                    start = s.size();
+                    return false;
+                }
+                _comment = comment::none;
+            }
+            else if (_comment == comment::block)
+            {
+                const auto end = detail::find_block_comment_end(p, last);
+                if (!end)
+                {
+                    // The last byte may be the '*' of "*/".
+                    start = std::max(p, last - 1) - first;
+                    return false;
+                }
+                p = end + 2;
+                _comment = comment::none;
+            }
+
+            p = detail::skip_whitespaces(p, last);
+            start = p - first;
+            if (p == last)
+                return false;
+            if (*p != '/')
+                return true;
+            if (p + 1 == last)
+                return false;
+
+            if (p[1] == '/')
+            {
+                _comment = comment::line;
+            }
+            else if (p[1] == '*')
+            {
+                _comment = comment::block;
+            }
+            else
+            {
+                // Reported by the lexer, with the character after '/',
+                // which must be whole.
+                return detail::byte_count_utf8(p[1]) <=
+                    static_cast<size_t>(last - p - 1);
+            }
+            p += 2;
+        }
+    }
+
+
+
+    /*
+     * Whether the token at start cannot be continued by the next chunk. If it
+     * can, the bytes checked so far are remembered, so that a long token split
+     * over many chunks is scanned only once.
+     */
+    bool is_complete_token(std::string_view s, size_t start)
+    {
+        const auto last = s.data() + s.size();
+        const auto token = s.data() + start;
+        auto p = token + _scanned;
+        const auto c = *token;
+        if (c == '"' || c == '\'')
+        {
+            if (p == token)
+            {
+                ++p;
+            }
+            while (true)
+            {
+                p = detail::find_string_special(p, last, c);
+                if (p == last)
+                    break;
+                // A raw line break cannot be in a string; the lexer reports it
+                // at once instead of waiting for the closing quote. Whether
+                // "\r" is followed by "\n" changes the message, though.
+                if (*p == '\r' && last - p < 2)
+                    break;
+                if (*p == c || *p == '\r' || *p == '\n')
+                {
+                    _scanned = 0;
+                    return true;
+                }
+                // *p is '\\'. The escaped character cannot close the string,
+                // and an escaped "\r\n" is one line break.
+                if (last - p < 2 || (p[1] == '\r' && last - p < 3))
+                    break;
+                p += p[1] == '\r' && p[2] == '\n' ? 3 : 2;
+            }
+            _scanned = p - token;
+            return false;
+        }
+
+        // Numbers and literals end at the first byte which cannot be part of
+        // them.
+        while (p != last &&
+               (detail::is_identifier_continue(*p) || *p == '+' || *p == '-' ||
+                *p == '.'))
+        {
+            ++p;
+        }
+        // If the token is invalid, the error message shows the character
+        // after it, which must be whole.
+        if (p == last ||
+            static_cast<size_t>(last - p) < detail::byte_count_utf8(*p))
+        {
+            _scanned = p - token;
+            return false;
+        }
+        _scanned = 0;
+        return true;
+    }
+};
+
+} // namespace json5
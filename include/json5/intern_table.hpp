@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string_view>
+#include <vector>
+#include "./detail/arena.hpp"
+
+
+
+namespace json5
+{
+
+/*
+ * Stores each distinct string once. Strings returned by intern() stay valid
+ * as long as the table is alive, and two strings interned in the same table
+ * are equal if and only if their data() pointers are equal.
+ *
+ * A table constructed with thread_safe = true may be shared by documents
+ * parsed concurrently.
+ */
+class intern_table
+{
+public:
+    struct statistics
+    {
+        // Number of intern() calls.
+        size_t lookups = 0;
+        // Number of intern() calls which found the string already stored.
+        size_t hits = 0;
+        // Number of distinct strings and their total length.
+        size_t unique_strings = 0;
+        size_t unique_bytes = 0;
+        // Bytes which would have been copied again without interning.
+        size_t bytes_saved = 0;
+
+
+
+        double hit_rate() const noexcept
+        {
+            return lookups == 0 ? 0.0 : static_cast<double>(hits) / lookups;
+        }
+    };
+
+
+
+    explicit intern_table(bool thread_safe = false)
+        : _thread_safe(thread_safe)
+        , _slots(16)
+    {
+    }
+
+
+
+    intern_table(const intern_table&) = delete;
+    intern_table& operator=(const intern_table&) = delete;
+
+
+
+    std::string_view intern(std::string_view s)
+    {
+        if (!_thread_safe)
+            return intern_unlocked(s);
+
+        std::lock_guard<std::mutex> lock{_mutex};
+        return intern_unlocked(s);
+    }
+
+
+
+    // Returns the interned copy of s, or a view whose data() is nullptr if s
+    // has never been interned.
+    std::string_view find(std::string_view s) const
+    {
+        if (!_thread_safe)
+            return _slots[find_slot(s)];
+
+        std::lock_guard<std::mutex> lock{_mutex};
+        return _slots[find_slot(s)];
+    }
+
+
+
+    statistics stats() const
+    {
+        if (!_thread_safe)
+            return _stats;
+
+        std::lock_guard<std::mutex> lock{_mutex};
+        return _stats;
+    }
+
+
+
+private:
+    bool _thread_safe;
+    mutable std::mutex _mutex;
+    detail::arena _arena;
+    // Open addressing with linear probing. Empty slots have null data().
+    std::vector<std::string_view> _slots;
+    statistics _stats;
+
+
+
+    std::string_view intern_unlocked(std::string_view s)
+    {
+        ++_stats.lookups;
+        auto slot = find_slot(s);
+        if (_slots[slot].data())
+        {
+            ++_stats.hits;
+            _stats.bytes_saved += s.size();
+            return _slots[slot];
+        }
+
+        // Keep the load factor at most 1/2.
+        if (_slots.size() <= (_stats.unique_strings + 1) * 2)
+        {
+            rehash(_slots.size() * 2);
+            slot = find_slot(s);
+        }
+
+        // Allocate at least one byte so that the empty string is not null.
+        const auto p = _arena.allocate_array<char>(s.size() + 1);
+        std::memcpy(p, s.data(), s.size());
+        _slots[slot] = std::string_view{p, s.size()};
+        ++_stats.unique_strings;
+        _stats.unique_bytes += s.size();
+        return _slots[slot];
+    }
+
+
+
+    size_t find_slot(std::string_view s) const
+    {
+        const auto mask = _slots.size() - 1;
+        for (auto i = std::hash<std::string_view>{}(s) & mask;;
+             i = (i + 1) & mask)
+        {
+            if (!_slots[i].data() || _slots[i] == s)
+                return i;
+        }
+    }
+
+
+
+    void rehash(size_t size)
+    {
+        std::vector<std::string_view> old(size);
+        old.swap(_slots);
+        const auto mask = size - 1;
+        for (const auto& s : old)
+        {
+            if (!s.data())
+                continue;
+            auto i = std::hash<std::string_view>{}(s) & mask;
+            while (_slots[i].data())
+            {
+                i = (i + 1) & mask;
+            }
+            _slots[i] = s;
+        }
+    }
+};
+
+} // namespace json5
@@ -1,17 +1,221 @@
 #pragma once
 
+#include <istream>
+#include "./binding.hpp"
+#include "./cursor.hpp"
+#include "./dialect.hpp"
+#include "./detail/document_builder.hpp"
+#include "./detail/input_file.hpp"
 #include "./detail/parser.hpp"
 #include "./detail/pretty_printer.hpp"
+#include "./detail/value_builder.hpp"
+#include "./incremental_parser.hpp"
+#include "./lazy_document.hpp"
+#include "./parallel.hpp"
+#include "./parse_result.hpp"
+#include "./sax.hpp"
+#include "./select.hpp"
 
 
 
 namespace json5
 {
 
-inline value parse(const std::string& source)
+// Same as parse(), in another dialect, such as json_dialect. See
+// dialect.hpp.
+template <typename Dialect>
+value parse(std::string_view source)
 {
-    detail::parser p{source};
-    return p.parse();
+    detail::value_builder builder;
+    detail::parser<detail::value_builder, Dialect> p{source, builder};
+    p.parse();
+    return builder.finish();
+}
+
+
+
+// The source is not copied; it must outlive the call.
+inline value parse(std::string_view source)
+{
+    return parse<json5_extended_dialect>(source);
+}
+
+
+
+inline value parse(const char* source, size_t length)
+{
+    return parse(std::string_view{source, length});
+}
+
+
+
+// Same as try_parse(), in another dialect. See dialect.hpp.
+template <typename Dialect>
+parse_result try_parse(std::string_view source)
+{
+    detail::value_builder builder;
+    detail::parser<detail::value_builder, Dialect, true> p{source, builder};
+    p.parse();
+    if (p.error() == error_code::ok)
+    {
+        p.expect_eof();
+    }
+    if (p.error() != error_code::ok)
+        return parse_result{source, p.error(), p.error_offset()};
+
+    return parse_result{builder.finish()};
+}
+
+
+
+/*
+ * Same as parse(), except that an error in the source is returned instead of
+ * thrown, without building a message for it; see parse_result. It works
+ * when exceptions are disabled. The whole source must be one value: only
+ * whitespaces and comments may follow it.
+ */
+inline parse_result try_parse(std::string_view source)
+{
+    return try_parse<json5_extended_dialect>(source);
+}
+
+
+
+// Same as validate(), in another dialect. See dialect.hpp.
+template <typename Dialect>
+bool validate(std::string_view source)
+{
+    sax_handler handler;
+    detail::parser<sax_handler, Dialect, true, false> p{source, handler};
+    p.parse();
+    if (p.error() == error_code::ok)
+    {
+        p.expect_eof();
+    }
+    return p.error() == error_code::ok;
+}
+
+
+
+/*
+ * Returns whether the whole source is one value that parse() accepts, with
+ * only whitespaces and comments after it, without building anything or
+ * allocating memory. Everything parse() checks is checked, including escape
+ * sequences and the range of numbers, but strings are not decoded.
+ */
+inline bool validate(std::string_view source)
+{
+    return validate<json5_extended_dialect>(source);
+}
+
+
+
+// Parses the source into an arena-allocated, read-only document. Unlike
+// parse(), the result does not refer to the source.
+inline document parse_document(
+    std::string_view source,
+    const document_options& opts = {})
+{
+    // Decoded strings and nodes rarely need more memory than the source
+    // itself, so the first block usually holds the entire document.
+    detail::arena arena{source.size()};
+    std::unique_ptr<intern_table> own_table;
+    auto table = opts.shared_table;
+    if (opts.interns() && !table)
+    {
+        own_table = std::make_unique<intern_table>();
+        table = own_table.get();
+    }
+    detail::document_builder builder{arena, table, opts};
+    detail::parser<detail::document_builder> p{source, builder};
+    p.parse();
+    return document{
+        std::move(arena), std::move(own_table), table, builder.finish()};
+}
+
+
+
+// Indexes the structure of the source, leaving values to be decoded when they
+// are accessed. The source is not copied; it must outlive the document.
+inline lazy_document parse_lazy(std::string_view source)
+{
+    return lazy_document{source};
+}
+
+
+
+// Parses the source without building anything, reporting what it reads to
+// the handler instead. See sax_handler for the events.
+template <typename Handler>
+void sax_parse(std::string_view source, Handler& handler)
+{
+    detail::parser<Handler> p{source, handler};
+    p.parse();
+}
+
+
+
+// Same as sax_parse(), in another dialect. See dialect.hpp.
+template <typename Dialect, typename Handler>
+void sax_parse(std::string_view source, Handler& handler)
+{
+    detail::parser<Handler, Dialect> p{source, handler};
+    p.parse();
+}
+
+
+
+// Reads the stream to its end in chunks, so only the result and a bounded
+// buffer are held in memory.
+inline value parse(std::istream& in)
+{
+    detail::value_builder builder;
+    incremental_parser<detail::value_builder> p{builder};
+    p.feed(in);
+    p.finish();
+    return builder.finish();
+}
+
+
+
+// Same as parse(std::istream&), for a file or a pipe.
+inline value parse_fd(int fd)
+{
+    detail::value_builder builder;
+    incremental_parser<detail::value_builder> p{builder};
+    p.feed_fd(fd);
+    p.finish();
+    return builder.finish();
+}
+
+
+
+/*
+ * Parses a file in place. Large regular files are memory-mapped rather than
+ * copied; pipes and other special files are parsed as they are read. Either
+ * way, nothing but whitespaces and comments may follow the value.
+ */
+inline value parse_file(const std::string& path)
+{
+    detail::input_file f{path};
+    if (!f.is_regular())
+        return parse_fd(f.descriptor());
+
+    detail::value_builder builder;
+    detail::parser<detail::value_builder> p{f.contents(), builder};
+    p.parse();
+    p.expect_eof();
+    return builder.finish();
+}
+
+
+
+template <typename Handler>
+void sax_parse(std::istream& in, Handler& handler)
+{
+    incremental_parser<Handler> p{handler};
+    p.feed(in);
+    p.finish();
 }
 
 
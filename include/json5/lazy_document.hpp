@@ -0,0 +1,658 @@
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "./detail/lazy_index.hpp"
+#include "./detail/lexer.hpp"
+#include "./detail/object_builder.hpp"
+#include "./detail/parser.hpp"
+#include "./detail/preprocessor.hpp"
+#include "./value.hpp"
+
+
+
+namespace json5
+{
+namespace detail
+{
+
+// Refers to an entry of a lazy document's index.
+struct lazy_ref
+{
+    const char* source;
+    const lazy_entry* entries;
+    uint32_t index;
+
+
+
+    const lazy_entry& entry() const noexcept
+    {
+        return entries[index];
+    }
+
+
+
+    char first_char() const noexcept
+    {
+        return source[entry().offset];
+    }
+
+
+
+    bool is_container() const noexcept
+    {
+        return first_char() == '[' || first_char() == '{';
+    }
+
+
+
+    // Only for scalars and keys.
+    std::string_view text() const noexcept
+    {
+        return {source + entry().offset, entry().extent - entry().offset};
+    }
+
+
+
+    // The next sibling, skipping all entries inside this one.
+    lazy_ref next() const noexcept
+    {
+        return {source, entries, is_container() ? entry().extent : index + 1};
+    }
+
+
+
+    // Scans the text of a scalar or key, which the index builder has only
+    // skipped.
+    token scan(lexer& lx) const
+    {
+        const auto tok = lx.scan();
+        if (lx.position() != text().size())
+        {
+            JSON5_THROW(syntax_error{"invalid value: " + std::string{text()}});
+        }
+        return tok;
+    }
+
+
+
+    string_type decode_key() const
+    {
+        lexer lx{text()};
+        const auto tok = scan(lx);
+        switch (tok.type())
+        {
+        case token_type::null:
+        case token_type::true_:
+        case token_type::false_:
+        case token_type::infinity:
+        case token_type::nan: return string_type{text()};
+        case token_type::string:
+        case token_type::identifier: return string_type{tok.get_string()};
+        default: JSON5_THROW(parse_error(tok, "string or identifier"));
+        }
+    }
+
+
+
+    bool key_equals(std::string_view key) const
+    {
+        const auto t = text();
+        if (t[0] != '"' && t[0] != '\'')
+            return t == key;
+
+        // Quoted keys are compared without decoding unless they contain an
+        // escape sequence.
+        const auto inner = t.substr(1, t.size() - 2);
+        if (inner.find('\\') == std::string_view::npos)
+            return inner == key;
+
+        return decode_key() == key;
+    }
+};
+
+} // namespace detail
+
+
+
+class lazy_array;
+class lazy_object;
+
+
+
+/*
+ * Value in a lazy document. Nothing but the positions of values is known
+ * until it is accessed: numbers and strings are decoded, and checked, every
+ * time they are read. It is valid as long as the document and its source
+ * are alive.
+ */
+class lazy_value
+{
+public:
+    explicit lazy_value(detail::lazy_ref ref) noexcept
+        : _ref(ref)
+    {
+    }
+
+
+
+    value_type type() const
+    {
+        switch (_ref.first_char())
+        {
+        case '[': return value_type::array;
+        case '{': return value_type::object;
+        case '"':
+        case '\'': return value_type::string;
+        default: break;
+        }
+
+        detail::lexer lx{_ref.text()};
+        const auto tok = _ref.scan(lx);
+        switch (tok.type())
+        {
+        case detail::token_type::null: return value_type::null;
+        case detail::token_type::true_:
+        case detail::token_type::false_: return value_type::boolean;
+        case detail::token_type::integer: return value_type::integer;
+        case detail::token_type::infinity:
+        case detail::token_type::nan:
+        case detail::token_type::number: return value_type::number;
+        default: JSON5_THROW(detail::parse_error(tok, "any JSON5 value"));
+        }
+    }
+
+
+
+    bool is_null() const
+    {
+        return type() == value_type::null;
+    }
+
+
+
+    bool is_boolean() const
+    {
+        return type() == value_type::boolean;
+    }
+
+
+
+    bool is_integer() const
+    {
+        return type() == value_type::integer;
+    }
+
+
+
+    bool is_number() const
+    {
+        return type() == value_type::number;
+    }
+
+
+
+    bool is_string() const noexcept
+    {
+        return _ref.first_char() == '"' || _ref.first_char() == '\'';
+    }
+
+
+
+    bool is_array() const noexcept
+    {
+        return _ref.first_char() == '[';
+    }
+
+
+
+    bool is_object() const noexcept
+    {
+        return _ref.first_char() == '{';
+    }
+
+
+
+    boolean_type get_boolean() const
+    {
+        expect(value_type::boolean);
+        return _ref.first_char() == 't';
+    }
+
+
+
+    integer_type get_integer() const
+    {
+        expect(value_type::integer);
+        detail::lexer lx{_ref.text()};
+        return _ref.scan(lx).get_integer();
+    }
+
+
+
+    number_type get_number() const
+    {
+        expect(value_type::number);
+        detail::lexer lx{_ref.text()};
+        const auto tok = _ref.scan(lx);
+        switch (tok.type())
+        {
+        case detail::token_type::infinity: return detail::infinity();
+        case detail::token_type::nan: return detail::nan();
+        default: return tok.get_number();
+        }
+    }
+
+
+
+    string_type get_string() const
+    {
+        expect(value_type::string);
+        detail::lexer lx{_ref.text()};
+        return string_type{_ref.scan(lx).get_string()};
+    }
+
+
+
+    inline lazy_array get_array() const;
+    inline lazy_object get_object() const;
+
+
+
+    // Decodes the whole subtree into a value.
+    inline value to_value() const;
+
+
+
+private:
+    detail::lazy_ref _ref;
+
+
+
+    void expect(value_type expected_type) const
+    {
+        const auto actual_type = type();
+        if (actual_type != expected_type)
+        {
+            JSON5_THROW(invalid_type_error{actual_type, expected_type});
+        }
+    }
+};
+
+
+
+class lazy_array
+{
+public:
+    class iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = lazy_value;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = lazy_value;
+
+
+
+        explicit iterator(detail::lazy_ref ref) noexcept
+            : _ref(ref)
+        {
+        }
+
+
+
+        lazy_value operator*() const noexcept
+        {
+            return lazy_value{_ref};
+        }
+
+
+
+        iterator& operator++() noexcept
+        {
+            _ref = _ref.next();
+            return *this;
+        }
+
+
+
+        iterator operator++(int) noexcept
+        {
+            const auto ret = *this;
+            ++*this;
+            return ret;
+        }
+
+
+
+        bool operator==(const iterator& other) const noexcept
+        {
+            return _ref.index == other._ref.index;
+        }
+
+
+
+        bool operator!=(const iterator& other) const noexcept
+        {
+            return _ref.index != other._ref.index;
+        }
+
+
+
+    private:
+        detail::lazy_ref _ref;
+    };
+
+
+
+    explicit lazy_array(detail::lazy_ref ref) noexcept
+        : _ref(ref)
+    {
+    }
+
+
+
+    // Elements are counted by walking over them, skipping nested arrays and
+    // objects as a whole.
+    size_t size() const noexcept
+    {
+        return static_cast<size_t>(std::distance(begin(), end()));
+    }
+
+
+
+    bool empty() const noexcept
+    {
+        return begin() == end();
+    }
+
+
+
+    lazy_value at(size_t index) const
+    {
+        auto itr = begin();
+        for (size_t i = 0; i < index; ++i)
+        {
+            if (itr == end())
+                break;
+            ++itr;
+        }
+        if (itr == end())
+        {
+            JSON5_THROW(std::out_of_range{"lazy_array::at"});
+        }
+        return *itr;
+    }
+
+
+
+    iterator begin() const noexcept
+    {
+        return iterator{
+            detail::lazy_ref{_ref.source, _ref.entries, _ref.index + 1}};
+    }
+
+
+
+    iterator end() const noexcept
+    {
+        return iterator{detail::lazy_ref{
+            _ref.source, _ref.entries, _ref.entry().extent}};
+    }
+
+
+
+private:
+    detail::lazy_ref _ref;
+};
+
+
+
+/*
+ * Members are kept in source order. Lookup is a linear scan over the keys
+ * which skips member values as a whole, and returns the first member with
+ * the key.
+ */
+class lazy_object
+{
+public:
+    class iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<string_type, lazy_value>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = value_type;
+
+
+
+        explicit iterator(detail::lazy_ref key) noexcept
+            : _key(key)
+        {
+        }
+
+
+
+        // Decodes the key.
+        value_type operator*() const
+        {
+            return {_key.decode_key(), value()};
+        }
+
+
+
+        lazy_value value() const noexcept
+        {
+            return lazy_value{_key.next()};
+        }
+
+
+
+        iterator& operator++() noexcept
+        {
+            _key = _key.next().next();
+            return *this;
+        }
+
+
+
+        iterator operator++(int) noexcept
+        {
+            const auto ret = *this;
+            ++*this;
+            return ret;
+        }
+
+
+
+        bool operator==(const iterator& other) const noexcept
+        {
+            return _key.index == other._key.index;
+        }
+
+
+
+        bool operator!=(const iterator& other) const noexcept
+        {
+            return _key.index != other._key.index;
+        }
+
+
+
+    private:
+        friend class lazy_object;
+
+        detail::lazy_ref _key;
+    };
+
+
+
+    explicit lazy_object(detail::lazy_ref ref) noexcept
+        : _ref(ref)
+    {
+    }
+
+
+
+    size_t size() const noexcept
+    {
+        return static_cast<size_t>(std::distance(begin(), end()));
+    }
+
+
+
+    bool empty() const noexcept
+    {
+        return begin() == end();
+    }
+
+
+
+    iterator begin() const noexcept
+    {
+        return iterator{
+            detail::lazy_ref{_ref.source, _ref.entries, _ref.index + 1}};
+    }
+
+
+
+    iterator end() const noexcept
+    {
+        return iterator{detail::lazy_ref{
+            _ref.source, _ref.entries, _ref.entry().extent}};
+    }
+
+
+
+    iterator find(std::string_view key) const
+    {
+        const auto last = end();
+        for (auto itr = begin(); itr != last; ++itr)
+        {
+            if (itr._key.key_equals(key))
+                return itr;
+        }
+        return last;
+    }
+
+
+
+    size_t count(std::string_view key) const
+    {
+        return find(key) == end() ? 0 : 1;
+    }
+
+
+
+    lazy_value at(std::string_view key) const
+    {
+        const auto itr = find(key);
+        if (itr == end())
+        {
+            JSON5_THROW(std::out_of_range{"lazy_object::at"});
+        }
+        return itr.value();
+    }
+
+
+
+private:
+    detail::lazy_ref _ref;
+};
+
+
+
+inline lazy_array lazy_value::get_array() const
+{
+    expect(value_type::array);
+    return lazy_array{_ref};
+}
+
+
+
+inline lazy_object lazy_value::get_object() const
+{
+    expect(value_type::object);
+    return lazy_object{_ref};
+}
+
+
+
+inline value lazy_value::to_value() const
+{
+    switch (type())
+    {
+    case value_type::null: return value{};
+    case value_type::boolean: return value{get_boolean()};
+    case value_type::integer: return value{get_integer()};
+    case value_type::number: return value{get_number()};
+    case value_type::string: return value{get_string()};
+    case value_type::array:
+    {
+        value::array_type array;
+        for (const auto& v : get_array())
+        {
+            array.push_back(v.to_value());
+        }
+        return value{std::move(array)};
+    }
+    case value_type::object:
+    {
+        detail::object_builder<value::object_type> object;
+        const auto o = get_object();
+        for (auto itr = o.begin(); itr != o.end(); ++itr)
+        {
+            auto kvp = *itr;
+            object.add(std::move(kvp.first), kvp.second.to_value());
+        }
+        return value{object.finish()};
+    }
+    default: return value{}; // unreachable
+    }
+}
+
+
+
+/*
+ * A JSON5 document of which only the structure is indexed up front. Each
+ * value and key costs one 8-byte index entry, and is decoded only when it is
+ * accessed through lazy_value. The source is not copied; it must outlive
+ * the document.
+ */
+class lazy_document
+{
+public:
+    explicit lazy_document(std::string_view source)
+        : _source(source)
+        , _entries(detail::lazy_index_builder{source}.build())
+    {
+    }
+
+
+
+    lazy_value root() const noexcept
+    {
+        return lazy_value{detail::lazy_ref{_source.data(), _entries.data(), 0}};
+    }
+
+
+
+    size_t index_size() const noexcept
+    {
+        return _entries.size();
+    }
+
+
+
+private:
+    std::string_view _source;
+    std::vector<detail::lazy_entry> _entries;
+};
+
+} // namespace json5
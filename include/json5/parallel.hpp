@@ -0,0 +1,410 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "./detail/parser.hpp"
+#include "./detail/preprocessor.hpp"
+#include "./detail/splitter.hpp"
+#include "./detail/value_builder.hpp"
+#include "./value.hpp"
+
+
+
+namespace json5
+{
+
+struct parallel_options
+{
+    // Number of threads to parse on. 0 means one per hardware thread.
+    unsigned threads = 0;
+};
+
+
+
+namespace detail
+{
+
+inline unsigned thread_count(const parallel_options& opts) noexcept
+{
+    if (opts.threads != 0)
+        return opts.threads;
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+
+
+/*
+ * Parses the records of a JSON5 Lines source on worker threads, a batch of
+ * records at a time, and hands the values to the calling thread in record
+ * order. Workers stay at most a few batches ahead of the calling thread, so
+ * the values waiting to be handed over take bounded memory.
+ */
+class lines_parser
+{
+public:
+    lines_parser(std::string_view source, unsigned threads)
+        : _source(source)
+        , _records(split_lines(source))
+        , _threads(threads)
+    {
+    }
+
+
+
+    template <typename Callback>
+    void run(Callback& callback)
+    {
+        if (_threads <= 1 || _records.size() <= batch_size)
+        {
+            value_builder builder;
+            for (size_t i = 0; i < _records.size(); ++i)
+            {
+                callback(parse_record(i, builder));
+            }
+            return;
+        }
+
+        _batches.resize((_records.size() + batch_size - 1) / batch_size);
+        std::vector<std::thread> workers;
+        for (unsigned i = 0; i < _threads; ++i)
+        {
+            workers.emplace_back([this] { work(); });
+        }
+
+        std::exception_ptr error;
+        JSON5_TRY
+        {
+            consume(callback);
+        }
+        JSON5_CATCH(...)
+        {
+            error = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            _stop = true;
+        }
+        _cv.notify_all();
+        for (auto& w : workers)
+        {
+            w.join();
+        }
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+
+
+private:
+    struct batch
+    {
+        std::vector<value> values;
+        // Thrown by the record after the last one in values.
+        std::exception_ptr error;
+        bool done = false;
+    };
+
+    static constexpr size_t batch_size = 256;
+
+    std::string_view _source;
+    std::vector<std::string_view> _records;
+    unsigned _threads;
+    std::vector<batch> _batches;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    // The first batch no worker has taken yet.
+    size_t _next = 0;
+    // The first batch the calling thread has not handed over yet.
+    size_t _consumed = 0;
+    bool _stop = false;
+
+
+
+    value parse_record(size_t i, value_builder& builder)
+    {
+        const auto record = _records[i];
+#if JSON5_EXCEPTIONS
+        try
+        {
+            parser<value_builder> p{record, builder};
+            p.parse();
+            p.expect_eof();
+        }
+        catch (const syntax_error& e)
+        {
+            const auto line =
+                std::count(_source.data(), record.data(), '\n') + 1;
+            throw syntax_error{
+                "line " + std::to_string(line) + ": " + e.what()};
+        }
+#else
+        parser<value_builder> p{record, builder};
+        p.parse();
+        p.expect_eof();
+#endif
+        return builder.finish();
+    }
+
+
+
+    void work()
+    {
+        value_builder builder;
+        std::unique_lock<std::mutex> lock{_mutex};
+        while (true)
+        {
+            _cv.wait(lock, [this] {
+                return _stop || _next == _batches.size() ||
+                    _next < _consumed + _threads * 4;
+            });
+            if (_stop || _next == _batches.size())
+                return;
+
+            const auto b = _next++;
+            lock.unlock();
+
+            auto& out = _batches[b];
+            const auto first = b * batch_size;
+            const auto last = std::min(first + batch_size, _records.size());
+            out.values.reserve(last - first);
+            JSON5_TRY
+            {
+                for (size_t i = first; i < last; ++i)
+                {
+                    out.values.push_back(parse_record(i, builder));
+                }
+            }
+            JSON5_CATCH(...)
+            {
+                out.error = std::current_exception();
+            }
+
+            lock.lock();
+            out.done = true;
+            // Later batches would not be handed over anyway.
+            _stop = _stop || out.error;
+            _cv.notify_all();
+        }
+    }
+
+
+
+    template <typename Callback>
+    void consume(Callback& callback)
+    {
+        for (size_t b = 0; b < _batches.size(); ++b)
+        {
+            {
+                std::unique_lock<std::mutex> lock{_mutex};
+                _cv.wait(lock, [&] { return _batches[b].done; });
+            }
+
+            auto out = std::move(_batches[b]);
+            for (auto& v : out.values)
+            {
+                callback(std::move(v));
+            }
+            if (out.error)
+            {
+                std::rethrow_exception(out.error);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock{_mutex};
+                ++_consumed;
+            }
+            _cv.notify_all();
+        }
+    }
+};
+
+
+
+/*
+ * Parses the elements of a top-level array in runs, on worker threads, and
+ * joins the runs into one array. Anything else is parsed sequentially, as is
+ * the whole source once a run fails, so that errors are reported exactly as
+ * by parse().
+ */
+class array_parser
+{
+public:
+    array_parser(std::string_view source, unsigned threads)
+        : _source(source)
+        , _threads(threads)
+    {
+    }
+
+
+
+    value run()
+    {
+        // Smaller runs are not worth a thread.
+        constexpr size_t min_run_size = 64 * 1024;
+        // More runs than threads even out their parsing times.
+        const auto parts = std::min<size_t>(
+            size_t{_threads} * 4, _source.size() / min_run_size);
+        if (_threads <= 1 || parts <= 1)
+            return parse_sequentially();
+
+        _runs = split_array(_source, parts);
+        if (_runs.size() <= 1)
+            return parse_sequentially();
+
+        _results.resize(_runs.size());
+        std::vector<std::thread> workers;
+        for (unsigned i = 0; i < _threads; ++i)
+        {
+            workers.emplace_back([this] { work(); });
+        }
+        for (auto& w : workers)
+        {
+            w.join();
+        }
+        if (_error)
+        {
+            JSON5_TRY
+            {
+                std::rethrow_exception(_error);
+            }
+            JSON5_CATCH(const syntax_error&)
+            {
+                return parse_sequentially();
+            }
+        }
+
+        size_t size = 0;
+        for (const auto& r : _results)
+        {
+            size += r.size();
+        }
+        value::array_type array;
+        array.reserve(size);
+        for (auto& r : _results)
+        {
+            array.insert(
+                array.end(),
+                std::make_move_iterator(r.begin()),
+                std::make_move_iterator(r.end()));
+            value::array_type{}.swap(r);
+        }
+        return value{std::move(array)};
+    }
+
+
+
+private:
+    std::string_view _source;
+    unsigned _threads;
+    std::vector<std::string_view> _runs;
+    std::vector<value::array_type> _results;
+    std::atomic<size_t> _next{0};
+    std::atomic<bool> _failed{false};
+    // The first exception thrown by a worker.
+    std::exception_ptr _error;
+    std::mutex _mutex;
+
+
+
+    value parse_sequentially()
+    {
+        value_builder builder;
+        parser<value_builder> p{_source, builder};
+        p.parse();
+        return builder.finish();
+    }
+
+
+
+    void work()
+    {
+        value_builder builder;
+        while (!_failed)
+        {
+            const auto i = _next++;
+            if (_runs.size() <= i)
+                return;
+
+            JSON5_TRY
+            {
+                parser<value_builder> p{_runs[i], builder};
+                p.parse_elements(i + 1 == _runs.size());
+                _results[i] = std::move(builder.finish().get_array());
+            }
+            JSON5_CATCH(...)
+            {
+                std::lock_guard<std::mutex> lock{_mutex};
+                if (!_error)
+                {
+                    _error = std::current_exception();
+                }
+                _failed = true;
+            }
+        }
+    }
+};
+
+} // namespace detail
+
+
+
+/*
+ * Same as parse(), except that the elements of a top-level array are parsed
+ * on opts.threads threads. The array is split between elements, looking
+ * only at brackets, strings and comments, and the parts are joined into one
+ * value::array_type. Small sources are parsed on the calling thread.
+ */
+inline value parse_parallel(
+    std::string_view source,
+    const parallel_options& opts = {})
+{
+    detail::array_parser p{source, detail::thread_count(opts)};
+    return p.run();
+}
+
+
+
+/*
+ * Parses a JSON5 Lines source, i.e. values separated by line breaks, on
+ * opts.threads threads. callback(value&&) is called on the calling thread
+ * with each value, in source order. A value may span several lines inside
+ * its brackets. A syntax error is reported with the line the record starts
+ * on, after the values before it have been passed to callback.
+ */
+template <
+    typename Callback,
+    typename = std::enable_if_t<std::is_invocable<Callback&, value&&>::value>>
+void parse_lines(
+    std::string_view source,
+    Callback&& callback,
+    const parallel_options& opts = {})
+{
+    detail::lines_parser p{source, detail::thread_count(opts)};
+    p.run(callback);
+}
+
+
+
+inline std::vector<value> parse_lines(
+    std::string_view source,
+    const parallel_options& opts = {})
+{
+    std::vector<value> values;
+    parse_lines(
+        source, [&](value&& v) { values.push_back(std::move(v)); }, opts);
+    return values;
+}
+
+} // namespace json5
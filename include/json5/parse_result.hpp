@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <utility>
+#include "./error_code.hpp"
+#include "./value.hpp"
+
+
+
+namespace json5
+{
+
+/*
+ * What try_parse() returns: the value, or why and where the source failed to
+ * parse. Only the byte offset of the error is kept; its line and column are
+ * counted from the source when they are asked for, so the source must still
+ * be alive then.
+ */
+class parse_result
+{
+public:
+    explicit parse_result(value&& v)
+        : _value(std::move(v))
+    {
+    }
+
+
+
+    parse_result(std::string_view source, error_code error, size_t offset)
+        : _source(source)
+        , _error(error)
+        , _offset(offset)
+    {
+    }
+
+
+
+    explicit operator bool() const noexcept
+    {
+        return _error == error_code::ok;
+    }
+
+
+
+    error_code error() const noexcept
+    {
+        return _error;
+    }
+
+
+
+    // The byte offset of the error in the source.
+    size_t offset() const noexcept
+    {
+        return _offset;
+    }
+
+
+
+    // The line of the error, counted from 1. Lines end with "\n", "\r\n" or
+    // "\r".
+    size_t line() const noexcept
+    {
+        size_t line = 1;
+        for (size_t i = 0; i < _offset; ++i)
+        {
+            const auto c = _source[i];
+            if (c == '\n' || (c == '\r' && (i + 1 == _source.size() ||
+                                            _source[i + 1] != '\n')))
+            {
+                ++line;
+            }
+        }
+        return line;
+    }
+
+
+
+    // The column of the error, counted from 1 in UTF-8 characters.
+    size_t column() const noexcept
+    {
+        size_t column = 1;
+        for (auto i = _offset; i != 0; --i)
+        {
+            const auto c = static_cast<unsigned char>(_source[i - 1]);
+            if (c == '\n' || c == '\r')
+                break;
+            // Continuation bytes do not start a character.
+            if ((c & 0xC0) != 0x80)
+            {
+                ++column;
+            }
+        }
+        return column;
+    }
+
+
+
+    // The value, or null if parsing failed.
+    value& get() noexcept
+    {
+        return _value;
+    }
+
+
+
+    const value& get() const noexcept
+    {
+        return _value;
+    }
+
+
+
+private:
+    value _value;
+    std::string_view _source;
+    error_code _error = error_code::ok;
+    size_t _offset = 0;
+};
+
+} // namespace json5
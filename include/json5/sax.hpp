@@ -0,0 +1,85 @@
+#pragma once
+
+#include <string_view>
+#include "./types.hpp"
+
+
+
+namespace json5
+{
+
+/*
+ * Handler of the events reported by json5::sax_parse(). It does nothing on
+ * any event; derive from it and hide the events you are interested in. Any
+ * class which has all of these member functions can be used as a handler.
+ *
+ * Strings passed to on_string() and on_key() are valid only during the call.
+ * Throw an exception from a handler to stop parsing.
+ */
+struct sax_handler
+{
+    void on_null()
+    {
+    }
+
+
+
+    void on_boolean(boolean_type)
+    {
+    }
+
+
+
+    // Numeric literals without fraction or exponent, including hexadecimal
+    // ones.
+    void on_integer(integer_type)
+    {
+    }
+
+
+
+    // Other numeric literals, Infinity and NaN.
+    void on_number(number_type)
+    {
+    }
+
+
+
+    void on_string(std::string_view)
+    {
+    }
+
+
+
+    // Reported before the value of each member. Identifiers are reported as
+    // they are, e.g., {null: 1} reports "null".
+    void on_key(std::string_view)
+    {
+    }
+
+
+
+    void on_start_array()
+    {
+    }
+
+
+
+    void on_end_array()
+    {
+    }
+
+
+
+    void on_start_object()
+    {
+    }
+
+
+
+    void on_end_object()
+    {
+    }
+};
+
+} // namespace json5
@@ -0,0 +1,326 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "./binding.hpp"
+#include "./cursor.hpp"
+#include "./detail/object_builder.hpp"
+#include "./detail/parser.hpp"
+#include "./detail/preprocessor.hpp"
+#include "./detail/value_builder.hpp"
+#include "./value.hpp"
+
+
+
+namespace json5
+{
+namespace detail
+{
+
+// A reference token of a JSON Pointer.
+struct path_segment
+{
+    string_type key;
+    // The token is "*", which matches every key and index.
+    bool any = false;
+    // The index the token matches in arrays, or npos.
+    size_t index = npos;
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+
+
+    bool matches(std::string_view k) const noexcept
+    {
+        return any || key == k;
+    }
+
+
+
+    bool matches(size_t i) const noexcept
+    {
+        return any || index == i;
+    }
+};
+
+
+
+// Splits a JSON Pointer (RFC 6901), in which "*" also stands for any key or
+// index, into its reference tokens.
+inline std::vector<path_segment> parse_path(std::string_view path)
+{
+    std::vector<path_segment> segments;
+    if (path.empty())
+        return segments;
+
+    if (path[0] != '/')
+    {
+        JSON5_THROW(
+            std::invalid_argument{"invalid path: " + std::string{path}});
+    }
+
+    size_t pos = 1;
+    while (true)
+    {
+        const auto end = std::min(path.find('/', pos), path.size());
+        auto& s = segments.emplace_back();
+        for (auto i = pos; i < end; ++i)
+        {
+            if (path[i] != '~')
+            {
+                s.key += path[i];
+            }
+            else if (i + 1 < end && (path[i + 1] == '0' || path[i + 1] == '1'))
+            {
+                s.key += path[++i] == '0' ? '~' : '/';
+            }
+            else
+            {
+                JSON5_THROW(std::invalid_argument{
+                    "invalid path: " + std::string{path}});
+            }
+        }
+        s.any = path.substr(pos, end - pos) == "*";
+
+        // Array indices have no leading zeros.
+        const auto& k = s.key;
+        if (!k.empty() && k.size() <= 9 && (k[0] != '0' || k.size() == 1) &&
+            k.find_first_not_of("0123456789") == std::string::npos)
+        {
+            s.index = 0;
+            for (const auto c : k)
+            {
+                s.index = s.index * 10 + static_cast<size_t>(c - '0');
+            }
+        }
+
+        if (end == path.size())
+            break;
+        pos = end + 1;
+    }
+    return segments;
+}
+
+
+
+/*
+ * Reads the parts of a source selected by paths. Containers on the way to a
+ * selected value are walked with a cursor, and everything beside the paths
+ * is skipped without being decoded.
+ */
+class path_selector
+{
+public:
+    path_selector(
+        std::string_view source,
+        const std::vector<std::string_view>& paths)
+        : _source(source)
+        , _cursor(source)
+    {
+        for (const auto p : paths)
+        {
+            _paths.push_back(parse_path(p));
+        }
+    }
+
+
+
+    value run()
+    {
+        for (const auto& p : _paths)
+        {
+            if (p.empty())
+            {
+                value_builder builder;
+                parser<value_builder> whole{_source, builder};
+                whole.parse();
+                return builder.finish();
+            }
+        }
+
+        value root;
+        const auto e = _cursor.next();
+        if (e == cursor_event::start_array || e == cursor_event::start_object)
+        {
+            for (size_t i = 0; i < _paths.size(); ++i)
+            {
+                _live.push_back(i);
+            }
+            read_container(0, 0, _live.size(), root);
+        }
+        _cursor.next(); // eof
+        return root;
+    }
+
+
+
+private:
+    std::string_view _source;
+    cursor _cursor;
+    std::vector<std::vector<path_segment>> _paths;
+    /*
+     * Paths which have matched the containers being read so far. Those of
+     * each container follow those of its parent; read_container() is given
+     * the range of its own.
+     */
+    std::vector<size_t> _live;
+
+
+
+    /*
+     * Reads the container whose start is the current event, of which the
+     * paths in _live[first, last) select parts at depth. Returns whether
+     * anything was selected, in which case it is stored in out. Elements of
+     * arrays which are not selected are null if they come before selected
+     * ones, so that those keep their indices, and dropped otherwise.
+     */
+    bool read_container(size_t depth, size_t first, size_t last, value& out)
+    {
+        if (_cursor.event() == cursor_event::start_object)
+        {
+            object_builder<value::object_type> object;
+            bool selected = false;
+            while (_cursor.next() == cursor_event::key)
+            {
+                const auto key = _cursor.get_string();
+                const bool whole = match(depth, first, last, [&](auto& s) {
+                    return s.matches(key);
+                });
+                if (!whole && _live.size() == last)
+                {
+                    _cursor.skip();
+                    continue;
+                }
+
+                // The key is only valid until the next event.
+                string_type k{key};
+                _cursor.next();
+                value v;
+                if (read_selected(depth, last, whole, v))
+                {
+                    object.add(std::move(k), std::move(v));
+                    selected = true;
+                }
+            }
+            if (selected)
+            {
+                out = value{object.finish()};
+            }
+            return selected;
+        }
+
+        value::array_type array;
+        size_t index = 0;
+        size_t skipped = 0;
+        while (_cursor.next() != cursor_event::end_array)
+        {
+            const bool whole = match(depth, first, last, [&](auto& s) {
+                return s.matches(index);
+            });
+            ++index;
+            value v;
+            if (!whole && _live.size() == last)
+            {
+                _cursor.skip();
+            }
+            else if (read_selected(depth, last, whole, v))
+            {
+                array.resize(array.size() + skipped);
+                array.push_back(std::move(v));
+                skipped = 0;
+                continue;
+            }
+            ++skipped;
+        }
+        if (array.empty())
+            return false;
+
+        out = value{std::move(array)};
+        return true;
+    }
+
+
+
+    /*
+     * Appends to _live the paths of _live[first, last) whose segment at
+     * depth matches, according to pred, and which go further. Returns
+     * whether one of them ends there instead.
+     */
+    template <typename Predicate>
+    bool match(size_t depth, size_t first, size_t last, Predicate&& pred)
+    {
+        bool whole = false;
+        for (auto i = first; i < last; ++i)
+        {
+            const auto& p = _paths[_live[i]];
+            if (!pred(p[depth]))
+                continue;
+
+            if (p.size() == depth + 1)
+            {
+                whole = true;
+            }
+            else
+            {
+                _live.push_back(_live[i]);
+            }
+        }
+        return whole;
+    }
+
+
+
+    /*
+     * Reads the value whose first event is the current one. It is selected
+     * as a whole, or the paths appended to _live by match() after last may
+     * select parts of it.
+     */
+    bool read_selected(size_t depth, size_t last, bool whole, value& out)
+    {
+        bool selected = false;
+        const auto e = _cursor.event();
+        if (whole)
+        {
+            binder<value>::read(_cursor, out);
+            selected = true;
+        }
+        else if (e == cursor_event::start_array ||
+                 e == cursor_event::start_object)
+        {
+            selected = read_container(depth + 1, last, _live.size(), out);
+        }
+        // Otherwise, the paths go through a scalar and select nothing.
+        _live.resize(last);
+        return selected;
+    }
+};
+
+} // namespace detail
+
+
+
+/*
+ * Parses only the parts of the source selected by paths, and returns them
+ * in the arrays and objects they belong to; the rest is skipped at about
+ * the speed of scanning, without being decoded or validated beyond its
+ * brackets. Paths are JSON Pointers (RFC 6901), such as
+ * "/config/graphics/width", in which "*" matches every key or index.
+ * Returns null if nothing is selected.
+ *
+ * Of a key which occurs more than once in an object, the first occurrence
+ * under which something is selected is kept, rather than the first one.
+ */
+inline value parse_selected(
+    std::string_view source,
+    const std::vector<std::string_view>& paths)
+{
+    detail::path_selector s{source, paths};
+    return s.run();
+}
+
+} // namespace json5
@@ -2,7 +2,10 @@
 
 #include <cstdint>
 #include <map>
+#include <string>
 #include <vector>
+#include "./flat_map.hpp"
+#include "./hash_map.hpp"
 
 
 
@@ -18,7 +21,18 @@ using string_type = std::string;
 template <typename T>
 using array_container_type = std::vector<T>;
 
+/*
+ * JSON5_OBJECT_CONTAINER selects the container of object members. It names a
+ * class template taking the key and the mapped type, such as json5::flat_map
+ * (sorted vector) or json5::hash_map (open addressing, source order).
+ * std::map is used by default.
+ */
+#if defined(JSON5_OBJECT_CONTAINER)
+template <typename K, typename V>
+using object_container_type = JSON5_OBJECT_CONTAINER<K, V>;
+#else
 template <typename K, typename V>
 using object_container_type = std::map<K, V>;
+#endif
 
 } // namespace json5
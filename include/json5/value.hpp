@@ -1,5 +1,9 @@
 #pragma once
 
+#include <cmath>
+#include <new>
+#include <utility>
+#include "./detail/preprocessor.hpp"
 #include "./exceptions.hpp"
 #include "./types.hpp"
 
@@ -67,7 +71,7 @@ public:
 
     value(const string_type& v)
         : _type(value_type::string)
-        , _as(new string_type(v))
+        , _as(make_string(string_type(v)))
     {
     }
 
@@ -75,7 +79,7 @@ public:
 
     value(string_type&& v)
         : _type(value_type::string)
-        , _as(new string_type(std::move(v)))
+        , _as(make_string(std::move(v)))
     {
     }
 
@@ -83,7 +87,7 @@ public:
 
     value(const string_type::value_type* v)
         : _type(value_type::string)
-        , _as(new string_type(v))
+        , _as(make_string(string_type(v)))
     {
     }
 
@@ -141,12 +145,20 @@ public:
 
     value(const value& other)
         : _type(other._type)
-        , _as(other._as)
+        , _as(null_type{})
     {
         switch (_type)
         {
+        case value_type::null: break;
+        case value_type::boolean: _as.boolean = other._as.boolean; break;
+        case value_type::integer: _as.integer = other._as.integer; break;
+        case value_type::number: _as.number = other._as.number; break;
         case value_type::string:
+#if defined(JSON5_INLINE_STRINGS)
+            new (&_as.string) string_type(other._as.string);
+#else
             _as.string = new string_type(*other._as.string);
+#endif
             break;
         case value_type::array:
             _as.array = new array_type(*other._as.array);
@@ -154,7 +166,7 @@ public:
         case value_type::object:
             _as.object = new object_type(*other._as.object);
             break;
-        default: break;
+        default: break; // unreachable
         }
     }
 
@@ -162,15 +174,9 @@ public:
 
     value(value&& other) noexcept
         : _type(other._type)
-        , _as(other._as)
+        , _as(null_type{})
     {
-        switch (_type)
-        {
-        case value_type::string: other._as.string = nullptr; break;
-        case value_type::array: other._as.array = nullptr; break;
-        case value_type::object: other._as.object = nullptr; break;
-        default: break;
-        }
+        move_from(other);
     }
 
 
@@ -195,25 +201,20 @@ public:
 
     ~value()
     {
-        switch (_type)
-        {
-        case value_type::null: break;
-        case value_type::boolean: break;
-        case value_type::integer: break;
-        case value_type::number: break;
-        case value_type::string: delete _as.string; break;
-        case value_type::array: delete _as.array; break;
-        case value_type::object: delete _as.object; break;
-        default: break; // unreachable
-        }
+        destroy();
     }
 
 
 
     void swap(value& other) noexcept
     {
-        std::swap(_type, other._type);
-        std::swap(_as, other._as);
+        value tmp{std::move(other)};
+        other.destroy();
+        other._type = _type;
+        other.move_from(*this);
+        destroy();
+        _type = tmp._type;
+        move_from(tmp);
     }
 
 
@@ -236,11 +237,16 @@ public:
 
 #define JSON5_IDENTITY(expr) expr
 #define JSON5_DEREFERENCE(expr) *(expr)
+#if defined(JSON5_INLINE_STRINGS)
+#define JSON5_STRING JSON5_IDENTITY
+#else
+#define JSON5_STRING JSON5_DEREFERENCE
+#endif
 
 #define JSON5_GET_METHOD_BODY(T, ret) \
     if (_type != value_type::T) \
     { \
-        throw invalid_type_error{_type, value_type::T}; \
+        JSON5_THROW(invalid_type_error{_type, value_type::T}); \
     } \
     return ret(_as.T);
 
@@ -270,7 +276,7 @@ public:
     JSON5_DEFINE_GET_METHOD(number, JSON5_IDENTITY)
 
     // get_string()
-    JSON5_DEFINE_GET_METHOD(string, JSON5_DEREFERENCE)
+    JSON5_DEFINE_GET_METHOD(string, JSON5_STRING)
 
     // get_array()
     JSON5_DEFINE_GET_METHOD(array, JSON5_DEREFERENCE)
@@ -345,7 +351,7 @@ public:
         case value_type::integer: return _as.integer == 0;
         case value_type::number:
             return _as.number == 0 || std::isnan(_as.number);
-        case value_type::string: return _as.string->empty();
+        case value_type::string: return get_string().empty();
         case value_type::array: return false;
         case value_type::object: return false;
         default: return false; // unreachable
@@ -358,13 +364,25 @@ private:
     value_type _type;
 
 
+    /*
+     * Strings, arrays and objects are held by pointer, which keeps value at
+     * 16 bytes. If JSON5_INLINE_STRINGS is defined, strings are stored in
+     * the union instead: short ones need no allocation at all thanks to the
+     * small string optimization of std::string, and long ones need one for
+     * their characters only, but every value grows to the size of
+     * std::string plus its type (40 bytes with libstdc++).
+     */
     union _U
     {
         null_type null;
         boolean_type boolean;
         integer_type integer;
         number_type number;
+#if defined(JSON5_INLINE_STRINGS)
+        string_type string;
+#else
         string_type* string;
+#endif
         array_type* array;
         object_type* object;
 
@@ -394,10 +412,17 @@ private:
         }
 
 
+#if defined(JSON5_INLINE_STRINGS)
+        _U(string_type&& v)
+            : string(std::move(v))
+        {
+        }
+#else
         constexpr _U(string_type* v)
             : string(v)
         {
         }
+#endif
 
 
         constexpr _U(array_type* v)
@@ -410,7 +435,80 @@ private:
             : object(v)
         {
         }
+
+
+        // The active member is destroyed by value::destroy().
+        ~_U()
+        {
+        }
     } _as;
+
+
+
+#if defined(JSON5_INLINE_STRINGS)
+    static string_type&& make_string(string_type&& s) noexcept
+    {
+        return std::move(s);
+    }
+#else
+    static string_type* make_string(string_type&& s)
+    {
+        return new string_type(std::move(s));
+    }
+#endif
+
+
+
+    void destroy() noexcept
+    {
+        switch (_type)
+        {
+        case value_type::null: break;
+        case value_type::boolean: break;
+        case value_type::integer: break;
+        case value_type::number: break;
+#if defined(JSON5_INLINE_STRINGS)
+        case value_type::string: _as.string.~string_type(); break;
+#else
+        case value_type::string: delete _as.string; break;
+#endif
+        case value_type::array: delete _as.array; break;
+        case value_type::object: delete _as.object; break;
+        default: break; // unreachable
+        }
+    }
+
+
+
+    // Takes over the payload of other whose type is _type. The storage of
+    // this must not hold a live object.
+    void move_from(value& other) noexcept
+    {
+        switch (_type)
+        {
+        case value_type::null: break;
+        case value_type::boolean: _as.boolean = other._as.boolean; break;
+        case value_type::integer: _as.integer = other._as.integer; break;
+        case value_type::number: _as.number = other._as.number; break;
+        case value_type::string:
+#if defined(JSON5_INLINE_STRINGS)
+            new (&_as.string) string_type(std::move(other._as.string));
+#else
+            _as.string = other._as.string;
+            other._as.string = nullptr;
+#endif
+            break;
+        case value_type::array:
+            _as.array = other._as.array;
+            other._as.array = nullptr;
+            break;
+        case value_type::object:
+            _as.object = other._as.object;
+            other._as.object = nullptr;
+            break;
+        default: break; // unreachable
+        }
+    }
 };
 
 
@@ -443,7 +541,7 @@ JSON5_DEFINE_GET_METHOD(integer, JSON5_IDENTITY)
 JSON5_DEFINE_GET_METHOD(number, JSON5_IDENTITY)
 
 // get<string_type>()
-JSON5_DEFINE_GET_METHOD(string, JSON5_DEREFERENCE)
+JSON5_DEFINE_GET_METHOD(string, JSON5_STRING)
 
 // get<array_type>()
 JSON5_DEFINE_GET_METHOD(array, JSON5_DEREFERENCE)
@@ -455,6 +553,7 @@ JSON5_DEFINE_GET_METHOD(object, JSON5_DEREFERENCE)
 
 #undef JSON5_DEFINE_GET_METHOD
 #undef JSON5_GET_METHOD_BODY
+#undef JSON5_STRING
 #undef JSON5_DEREFERENCE
 #undef JSON5_IDENTITY
 